@@ -1,4 +1,8 @@
+#include <algorithm>
+#include <array>
 #include <cstdio>
+#include <type_traits>
+#include <vector>
 
 #include "vfsm/vfsm.hpp"
 
@@ -10,6 +14,13 @@ struct Reset   {};
 
 namespace Local {
 
+// Console output at runtime only: the machine runs in constant evaluation too
+constexpr void log(char const *message)
+{
+    if (!std::is_constant_evaluated())
+        std::puts(message);
+}
+
 // States
 struct Init { };
 struct Run  { };
@@ -30,30 +41,30 @@ struct FsmContext
     constexpr auto operator()()
     {
         return vfsm::overload {
-            [this](Init, Ev::Process) -> Run  { std::puts("init"); return {}; },
+            [this](Init, Ev::Process) -> Run  { log("init"); return {}; },
             [this](Run,  Ev::Process) -> std::variant<Run, Done, Fail> {
-            std::puts("run");
+            log("run");
             if (++ctx.counter == 5) {
                 if (ctx.is_fail) return Fail{};
                 return Done{};
             }
             return {};
         },
-            [](Done, Ev::Process) -> Done { std::puts("done"); return {}; },
-            [](Fail, Ev::Process) -> Fail { std::puts("fail"); return {}; },
+            [](Done, Ev::Process) -> Done { log("done"); return {}; },
+            [](Fail, Ev::Process) -> Fail { log("fail"); return {}; },
             // Any State event processing
             [](auto, Ev::Reset)   -> Init { return {}; },
 
             // Run State polling CB. Return value deternmine new state. Maybe void to keep state
-            [](Run)                     { std::puts("== Run State Poll"); },
+            [](Run)                     { log("== Run State Poll"); },
 
             // OnEnter/OnExit cases
-            [this](Init, auto, vfsm::OnEnter) { std::puts("++ Init onEnter"); ctx = {}; },
-            [    ](Init, auto, vfsm::OnExit)  { std::puts("-- Init onExit"); },
-            [    ](Run,  auto, vfsm::OnEnter) { std::puts("++ Run onEnter"); },
-            [    ](Run,  auto, vfsm::OnExit)  { std::puts("-- Run onExit"); },
-            [    ](auto, auto, vfsm::OnEnter) { std::puts("++ Generic onEnter"); },
-            [    ](auto, auto, vfsm::OnExit)  { std::puts("-- Generic onExit"); }
+            [this](Init, auto, vfsm::OnEnter) { log("++ Init onEnter"); ctx = {}; },
+            [    ](Init, auto, vfsm::OnExit)  { log("-- Init onExit"); },
+            [    ](Run,  auto, vfsm::OnEnter) { log("++ Run onEnter"); },
+            [    ](Run,  auto, vfsm::OnExit)  { log("-- Run onExit"); },
+            [    ](auto, auto, vfsm::OnEnter) { log("++ Generic onEnter"); },
+            [    ](auto, auto, vfsm::OnExit)  { log("-- Generic onExit"); }
         };
     }
 
@@ -63,6 +74,39 @@ struct FsmContext
 // Declare machine
 using Fsm = vfsm::Fsm<FsmContext, Init, Run, Fail, Done, Wait>;
 
+// Same machine evaluated by the compiler
+constexpr std::size_t stateAfter(int events, bool fail)
+{
+    Fsm sm{FsmContext{}, Init{}};
+    sm.context().ctx.is_fail = fail;
+    for (int i = 0; i < events; ++i)
+        sm.processEvent(Ev::Process{});
+    sm.poll();
+    return sm.state_index();
+}
+
+static_assert(stateAfter(5, false) == Fsm::index_of<Run>());
+static_assert(stateAfter(6, false) == Fsm::index_of<Done>());
+static_assert(stateAfter(6, true) == Fsm::index_of<Fail>());
+
+constexpr bool resetsAtCompileTime()
+{
+    Fsm sm{FsmContext{}, Init{}};
+    sm.processEvent(Ev::Process{});
+    sm.reset_with_exit(Init{});
+    if (sm.state_index() != Fsm::index_of<Init>())
+        return false;
+
+    std::array<Fsm, 3> pool{sm.fork(), sm.fork(), sm.fork()};
+    pool[1].processEvent(Ev::Process{});
+    pool[1].processEvent(Ev::Reset{});
+    pool[2].processEvent(Ev::Process{});
+    Fsm::reset_all(pool, Init{});
+    return std::all_of(pool.begin(), pool.end(), [](auto const& m) { return m.state_index() == Fsm::index_of<Init>(); });
+}
+
+static_assert(resetsAtCompileTime());
+
 };
 
 
@@ -95,12 +139,12 @@ auto main() noexcept -> int
     sm.processEvent(Ev::Process{});
 
     //
-    // Two ways to reset state machine
+    // Three ways to reset state machine
     //
 
     std::puts("\nMake MachineReset 1: no current state OnExit()\n");
 
-    sm = Local::Fsm{Local::FsmContext{}, Local::Init{}};
+    sm.reset(Local::Init{}); // same as: sm = Local::Fsm{Local::FsmContext{}, Local::Init{}};
     sm.context().ctx.is_fail = true;
 
     sm.processEvent(Ev::Process{});
@@ -129,5 +173,23 @@ auto main() noexcept -> int
     sm.processEvent(Ev::Process{});
     sm.processEvent(Ev::Process{});
 
+
+    std::puts("\nMake MachineReset 3 :: in-place with current state OnExit()\n");
+
+    sm.reset_with_exit(Local::Init{});
+
+    sm.processEvent(Ev::Process{});
+    sm.processEvent(Ev::Process{});
+
+    //
+    // Bulk reset of the machines pool
+    //
+
+    std::puts("\nMake MachineReset for pool\n");
+
+    std::vector<Local::Fsm> pool(4, Local::Fsm{Local::FsmContext{}, Local::Init{}});
+    pool[1].processEvent(Ev::Process{});
+    Local::Fsm::reset_all(pool, Local::Init{});
+
     return 0;
 }
@@ -0,0 +1,146 @@
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <vector>
+
+#include "vfsm/any_fsm.hpp"
+
+namespace Ev {
+struct Toggle {};
+struct Reset  {};
+}
+
+namespace Lamp {
+
+struct Off {};
+struct On  {};
+
+struct Context
+{
+    constexpr auto operator()()
+    {
+        return vfsm::overload {
+            [this](Off, Ev::Toggle) -> On  { ++switches; return {}; },
+            [    ](On,  Ev::Toggle) -> Off { return {}; },
+            [    ](auto, Ev::Reset) -> Off { return {}; }
+        };
+    }
+
+    unsigned switches = 0;
+};
+
+using Fsm = vfsm::Fsm<Context, Off, On>;
+
+}
+
+namespace Counter {
+
+struct Idle  {};
+struct Count {};
+struct Full  {};
+
+struct Context
+{
+    constexpr auto operator()()
+    {
+        return vfsm::overload {
+            [this](Idle,  Ev::Toggle) -> Count { value = 1; return {}; },
+            [this](Count, Ev::Toggle) -> std::variant<Count, Full> {
+                if (++value == limit) return Full{};
+                return {};
+            },
+            [    ](auto,  Ev::Reset)  -> Idle  { return {}; },
+            // Full state ignores Toggle, polling returns it to Idle
+            [    ](Full) -> Idle { return {}; }
+        };
+    }
+
+    unsigned value = 0;
+    unsigned limit = 7;
+};
+
+using Fsm = vfsm::Fsm<Context, Idle, Count, Full>;
+
+}
+
+//
+// Reference: classic virtual-inheritance wrapper with heap allocated machines
+//
+struct IMachine
+{
+    virtual ~IMachine() = default;
+    virtual bool processEvent(Ev::Toggle ev) = 0;
+    virtual bool processEvent(Ev::Reset ev) = 0;
+    virtual bool poll() = 0;
+    virtual std::size_t state_index() const = 0;
+};
+
+template <class Machine>
+struct VirtualMachine final : IMachine
+{
+    explicit VirtualMachine(Machine &&m) : sm{std::move(m)} {}
+
+    bool processEvent(Ev::Toggle ev) override { return sm.processEvent(ev); }
+    bool processEvent(Ev::Reset ev) override { return sm.processEvent(ev); }
+    bool poll() override { return sm.poll(); }
+    std::size_t state_index() const override { return sm.state_index(); }
+
+    Machine sm;
+};
+
+using AnyMachine = vfsm::AnyFsm<32, Ev::Toggle, Ev::Reset>;
+
+template <class Registry>
+static double run(Registry &machines, unsigned rounds, std::size_t &checksum)
+{
+    auto const start = std::chrono::steady_clock::now();
+    for (unsigned r = 0; r < rounds; ++r) {
+        for (auto &sm : machines) {
+            if constexpr (requires { sm->poll(); }) {
+                sm->processEvent(Ev::Toggle{});
+                if ((r & 15) == 15)
+                    sm->processEvent(Ev::Reset{});
+                checksum += sm->state_index();
+            } else {
+                sm.processEvent(Ev::Toggle{});
+                if ((r & 15) == 15)
+                    sm.processEvent(Ev::Reset{});
+                checksum += sm.state_index();
+            }
+        }
+    }
+    auto const stop = std::chrono::steady_clock::now();
+    auto const ops = double(rounds) * double(machines.size());
+    return std::chrono::duration<double, std::nano>(stop - start).count() / ops;
+}
+
+int main()
+{
+    constexpr std::size_t count = 4096;
+    constexpr unsigned rounds = 2000;
+
+    std::vector<AnyMachine> any;
+    std::vector<std::unique_ptr<IMachine>> virt;
+    any.reserve(count);
+    virt.reserve(count);
+
+    for (std::size_t i = 0; i < count; ++i) {
+        if (i % 2) {
+            any.emplace_back(std::in_place_type<Lamp::Fsm>, Lamp::Context{}, Lamp::Off{});
+            virt.push_back(std::make_unique<VirtualMachine<Lamp::Fsm>>(Lamp::Fsm{Lamp::Context{}, Lamp::Off{}}));
+        } else {
+            any.emplace_back(std::in_place_type<Counter::Fsm>, Counter::Context{}, Counter::Idle{});
+            virt.push_back(std::make_unique<VirtualMachine<Counter::Fsm>>(Counter::Fsm{Counter::Context{}, Counter::Idle{}}));
+        }
+    }
+
+    std::size_t anySum = 0, virtSum = 0;
+    auto const anyNs  = run(any, rounds, anySum);
+    auto const virtNs = run(virt, rounds, virtSum);
+
+    std::printf("machines: %zu, rounds: %u\n", count, rounds);
+    std::printf("AnyFsm (in-place, one indirect call): %6.2f ns/step, checksum %zu\n", anyNs, anySum);
+    std::printf("virtual + unique_ptr               : %6.2f ns/step, checksum %zu\n", virtNs, virtSum);
+
+    return anySum == virtSum ? 0 : 1;
+}
@@ -0,0 +1,191 @@
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "vfsm/async.hpp"
+
+// FNV-1a over the large buffer: too slow for the dispatching thread
+static std::uint64_t checksum(std::vector<std::uint8_t> const& data, std::stop_token stop = {})
+{
+    std::uint64_t hash = 0xcbf29ce484222325ull;
+    for (std::size_t i = 0; i < data.size(); ++i) {
+        // Cooperative cancellation
+        if (i % 65536 == 0 && stop.stop_requested())
+            return 0;
+        hash = (hash ^ data[i]) * 0x100000001b3ull;
+    }
+    return hash;
+}
+
+namespace Ev {
+struct Block  { std::shared_ptr<std::vector<std::uint8_t> const> data; };
+struct Hashed { std::uint64_t hash{}; };
+struct Tick   {};
+struct Abort  {};
+}
+
+namespace Store {
+
+// States
+struct Idle    {};
+struct Hashing {};
+
+struct Context : vfsm::AsyncContext<Ev::Hashed>
+{
+    Context(vfsm::ThreadPool &pool, bool offloaded)
+        : AsyncContext{pool},
+          offload{offloaded}
+    {}
+
+    auto operator()()
+    {
+        return vfsm::overload{
+            [this](Idle, Ev::Block ev) -> std::variant<Hashing, Idle> {
+                if (!offload) {
+                    hashes.push_back(checksum(*ev.data));
+                    return Idle{};
+                }
+                launch([data = std::move(ev.data)](std::stop_token stop) { return Ev::Hashed{checksum(*data, stop)}; });
+                return Hashing{};
+            },
+            [this](Hashing, Ev::Hashed ev) -> Idle { hashes.push_back(ev.hash); return {}; },
+            // Leaving Hashing cancels the job
+            [](Hashing, Ev::Abort) -> Idle { return {}; },
+            [this](auto, Ev::Tick) { ++ticks; }
+        };
+    }
+
+    bool offload;
+    std::uint64_t ticks = 0;
+    std::vector<std::uint64_t> hashes;
+};
+
+using Fsm = vfsm::Fsm<Context, Idle, Hashing>;
+
+} // Store
+
+// Job launched by the initial OnEnter, its failure is delivered as the completion
+namespace Loader {
+
+// States
+struct Loading {};
+struct Ready   {};
+struct Failed  {};
+
+struct Context : vfsm::AsyncContext<Ev::Hashed, vfsm::JobFailed>
+{
+    using AsyncContext::AsyncContext;
+
+    auto operator()()
+    {
+        return vfsm::overload{
+            [this](Loading, vfsm::OnEnter) {
+                launch([]() -> Ev::Hashed { throw std::runtime_error{"no such block"}; });
+            },
+            [](Loading, Ev::Hashed) -> Ready { return {}; },
+            [this](Loading, vfsm::JobFailed ev) -> Failed {
+                try {
+                    std::rethrow_exception(ev.error);
+                } catch (std::exception const& e) {
+                    error = e.what();
+                }
+                return {};
+            }
+        };
+    }
+
+    std::string error;
+};
+
+using Fsm = vfsm::Fsm<Context, Loading, Ready, Failed>;
+
+} // Loader
+
+static void run(vfsm::ThreadPool &pool, bool offload)
+{
+    auto const block = std::make_shared<std::vector<std::uint8_t> const>(4 * 1024 * 1024, std::uint8_t(0x5a));
+    auto const expected = checksum(*block);
+
+    Store::Fsm sm{Store::Context{pool, offload}, Store::Idle{}};
+
+    using clock = std::chrono::steady_clock;
+    clock::duration worst{};
+    std::size_t blocks = 0;
+
+    auto const start = clock::now();
+    while (sm.context().hashes.size() < 16) {
+        auto const t0 = clock::now();
+        sm.processEvent(Ev::Tick{});
+        if (sm.state_index() == Store::Fsm::index_of<Store::Idle>()) {
+            ++blocks;
+            sm.processEvent(Ev::Block{block});
+        }
+        sm.context().dispatch(sm);
+        worst = std::max(worst, clock::now() - t0);
+    }
+    auto const total = clock::now() - start;
+
+    for (auto hash : sm.context().hashes) {
+        if (hash != expected)
+            std::fprintf(stderr, "checksum mismatch\n");
+    }
+
+    std::printf("%-7s: %zu blocks in %.1f ms, %llu ticks, worst event loop iteration %.3f ms\n",
+                offload ? "offload" : "inline", blocks,
+                std::chrono::duration<double, std::milli>(total).count(),
+                static_cast<unsigned long long>(sm.context().ticks),
+                std::chrono::duration<double, std::milli>(worst).count());
+}
+
+// Every job is aborted right after the launch: workers stop early, late completions never reach the machine
+static void runAborted(vfsm::ThreadPool &pool)
+{
+    auto const block = std::make_shared<std::vector<std::uint8_t> const>(64 * 1024 * 1024, std::uint8_t(0x5a));
+
+    Store::Fsm sm{Store::Context{pool, true}, Store::Idle{}};
+
+    auto const start = std::chrono::steady_clock::now();
+    for (unsigned i = 0; i < 64; ++i) {
+        sm.processEvent(Ev::Block{block});
+        sm.processEvent(Ev::Abort{});
+        sm.context().dispatch(sm);
+    }
+
+    // Drain: a short job goes through after all the cancelled ones
+    sm.processEvent(Ev::Block{std::make_shared<std::vector<std::uint8_t> const>(16)});
+    while (sm.context().hashes.empty())
+        sm.context().dispatch(sm);
+    auto const total = std::chrono::steady_clock::now() - start;
+
+    std::printf("abort  : 64 cancelled 64 MiB jobs in %.1f ms, delivered completions %zu\n",
+                std::chrono::duration<double, std::milli>(total).count(), sm.context().hashes.size());
+}
+
+// Machine leaves the waiting state when the job throws
+static bool runFailed(vfsm::ThreadPool &pool)
+{
+    Loader::Fsm sm{Loader::Context{pool}, Loader::Loading{}};
+    auto const start = std::chrono::steady_clock::now();
+    while (sm.state_index() == Loader::Fsm::index_of<Loader::Loading>() &&
+           std::chrono::steady_clock::now() - start < std::chrono::seconds{5})
+        sm.context().dispatch(sm);
+
+    auto const failed = sm.state_index() == Loader::Fsm::index_of<Loader::Failed>();
+    std::printf("failure: %s, error '%s'\n", failed ? "delivered" : "lost", sm.context().error.c_str());
+    return failed;
+}
+
+int main()
+{
+    vfsm::ThreadPool pool{2};
+
+    run(pool, false);
+    run(pool, true);
+    runAborted(pool);
+
+    return runFailed(pool) ? 0 : 1;
+}
@@ -0,0 +1,85 @@
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "vfsm/counters.hpp"
+
+namespace Ev {
+struct Connect {};
+struct Ack     {};
+struct Close   {};
+}
+
+// States
+struct Idle        {};
+struct Handshake   {};
+struct Established {};
+
+using Stats = vfsm::Counters<3, Ev::Connect, Ev::Ack, Ev::Close>;
+
+struct Session : vfsm::CountingContext<Stats>
+{
+    using CountingContext::CountingContext;
+
+    auto operator()()
+    {
+        return vfsm::overload{
+            [](Idle,        Ev::Connect) { return Handshake{}; },
+            [](Handshake,   Ev::Ack)     { return Established{}; },
+            [](Handshake,   Ev::Close)   { return Idle{}; },
+            [](Established, Ev::Close)   { return Idle{}; }
+        };
+    }
+};
+
+using Fsm = vfsm::Fsm<Session, Idle, Handshake, Established>;
+
+// "Ev::Connect", ...
+constexpr auto& eventNames = vfsm::type_names<Ev::Connect, Ev::Ack, Ev::Close>;
+
+int main(int argc, char **argv)
+{
+    constexpr std::size_t sessions = 1000;
+    constexpr std::size_t events = 4'000'000;
+    constexpr unsigned threads = 4;
+
+    Stats stats;
+
+    // Fleet of machines in every thread, all counted into the same statistics
+    auto const start = std::chrono::steady_clock::now();
+    {
+        std::vector<std::jthread> workers;
+        for (unsigned t = 0; t < threads; ++t) {
+            workers.emplace_back([&stats, t] {
+                std::vector<Fsm> pool;
+                pool.reserve(sessions);
+                for (std::size_t i = 0; i < sessions; ++i)
+                    pool.emplace_back(Session{stats}, Idle{});
+
+                std::mt19937 rng{t};
+                for (std::size_t i = 0; i < events; ++i) {
+                    auto &sm = pool[rng() % sessions];
+                    switch (rng() % 3) {
+                        case 0: sm.processEvent(Ev::Connect{}); break;
+                        case 1: sm.processEvent(Ev::Ack{}); break;
+                        default: sm.processEvent(Ev::Close{}); break;
+                    }
+                }
+            });
+        }
+    }
+    std::chrono::duration<double, std::nano> const elapsed = std::chrono::steady_clock::now() - start;
+    std::printf("%.1f ns/event\n", elapsed.count() / (events * threads));
+
+    // Scraped file, path from the command line
+    if (argc > 1) {
+        std::ofstream file{argv[1]};
+        stats.exportPrometheus(file, "session", Fsm::state_names, eventNames);
+    }
+    stats.exportPrometheus(std::cout, "session", Fsm::state_names, eventNames);
+}
@@ -0,0 +1,37 @@
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+
+#include "motor.hpp"
+
+#ifndef BUILD_LEVEL
+#  define BUILD_LEVEL ""
+#endif
+
+int main()
+{
+    Motor::Fsm sm{Motor::Controller{}, Motor::Idle{}};
+
+    // Control loop: speed command, ramp up, run, brake down to zero
+    constexpr int cycles = 200'000;
+    std::uint64_t events = 0;
+    auto const start = std::chrono::steady_clock::now();
+    for (int c = 0; c < cycles; ++c) {
+        auto const target = 1000 + c % 2500;
+        sm.processEvent(Ev::Command{target});
+        for (std::int32_t speed = 0; speed <= target; speed += 250, ++events)
+            sm.processEvent(Ev::Tick{speed});
+        for (int i = 0; i < 4; ++i, ++events)
+            sm.processEvent(Ev::Tick{target});
+        sm.processEvent(Ev::Stop{});
+        for (std::int32_t speed = target; speed >= 0; speed -= 500, ++events)
+            sm.processEvent(Ev::Tick{speed > 0 ? speed : 0});
+        sm.processEvent(Ev::Tick{0});
+        events += 3;
+    }
+    std::chrono::duration<double, std::nano> const elapsed = std::chrono::steady_clock::now() - start;
+
+    std::printf("%s %s dispatch: %.1f ns/event, ramps %u, brakes %u\n", BUILD_LEVEL,
+                VFSM_DEBUG_DISPATCH ? "table" : "std::visit", elapsed.count() / double(events), sm.context().ramps,
+                sm.context().brakes);
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstdint>
+
+#include "vfsm/vfsm.hpp"
+
+namespace Ev {
+struct Tick    { std::int32_t speed{}; };
+struct Command { std::int32_t target{}; };
+struct Stop    {};
+}
+
+namespace Motor {
+
+struct Idle    {};
+struct Ramp    {};
+struct Run     {};
+struct Brake   {};
+struct Fault   {};
+
+struct Controller
+{
+    auto operator()()
+    {
+        return vfsm::overload{
+            [this](Idle, Ev::Command ev) -> Ramp { target = ev.target; return {}; },
+            [this](Ramp, Ev::Tick ev) -> std::variant<Ramp, Run, Fault> {
+                if (ev.speed > limit) return Fault{};
+                if (ev.speed >= target) return Run{};
+                return Ramp{};
+            },
+            [this](Run, Ev::Tick ev) -> std::variant<Run, Fault> { if (ev.speed > limit) return Fault{}; return Run{}; },
+            [this](Run, Ev::Command ev) -> Ramp { target = ev.target; return {}; },
+            [](Ramp, Ev::Stop) -> Brake { return {}; },
+            [](Run, Ev::Stop) -> Brake { return {}; },
+            [](Brake, Ev::Tick ev) -> std::variant<Brake, Idle> { if (ev.speed == 0) return Idle{}; return Brake{}; },
+            [](Fault, Ev::Stop) -> Idle { return {}; },
+
+            [this](Ramp, vfsm::OnEnter) { ++ramps; },
+            [this](Brake, vfsm::OnEnter) { ++brakes; },
+            [this](Fault, vfsm::OnEnter) { ++faults; }
+        };
+    }
+
+    std::int32_t  target = 0;
+    std::int32_t  limit = 3000;
+    std::uint32_t ramps = 0;
+    std::uint32_t brakes = 0;
+    std::uint32_t faults = 0;
+};
+
+using Fsm = vfsm::Fsm<Controller, Idle, Ramp, Run, Brake, Fault>;
+
+} // Motor
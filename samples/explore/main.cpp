@@ -0,0 +1,106 @@
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+
+#include "vfsm/explore.hpp"
+
+namespace Ev {
+struct Open    {};
+struct Send    {};
+struct Ack     {};
+struct Timeout {};
+struct Close   {};
+}
+
+//
+// Toy sliding window sender: enough context to produce the sizeable configuration space
+//
+namespace Sender {
+
+// States
+struct Closed      {};
+struct Established {};
+struct Backoff     {};
+struct Closing     {};
+
+struct Context
+{
+    static constexpr std::uint8_t window = 16;
+    static constexpr std::uint8_t maxRetries = 4;
+
+    constexpr auto operator()()
+    {
+        return vfsm::overload {
+            [this](Closed,      Ev::Open)    -> Established { *this = {}; return {}; },
+            [this](Established, Ev::Send)    -> Established { if (inFlight < window) { ++next; ++inFlight; } return {}; },
+            [this](Established, Ev::Ack)     -> Established { if (inFlight) { --inFlight; ++acked; } retries = 0; return {}; },
+            [this](Established, Ev::Timeout) -> std::variant<Backoff, Closed> {
+                if (!inFlight) return Backoff{};
+                if (++retries > maxRetries) return Closed{};
+                next = std::uint8_t(next - inFlight); // go-back-N
+                inFlight = 0;
+                return {};
+            },
+            [    ](Backoff,     Ev::Timeout) -> Established { return {}; },
+            [this](Backoff,     Ev::Ack)     -> Established { retries = 0; return {}; },
+            [    ](Established, Ev::Close)   -> Closing { return {}; },
+            [this](Closing,     Ev::Ack)     -> std::variant<Closing, Closed> { if (inFlight) { --inFlight; return {}; } return Closed{}; },
+            [    ](Closing,     Ev::Timeout) -> Closed { return {}; }
+        };
+    }
+
+    std::uint8_t next = 0;
+    std::uint8_t acked = 0;
+    std::uint8_t inFlight = 0;
+    std::uint8_t retries = 0;
+};
+
+using Fsm = vfsm::Fsm<Context, Closed, Established, Backoff, Closing>;
+
+}
+
+int main(int argc, char *argv[])
+{
+    auto const threads = argc > 1 ? unsigned(std::atoi(argv[1])) : std::max(1u, std::thread::hardware_concurrency());
+
+    auto const hash = [](Sender::Context const& c) -> std::uint64_t {
+        return std::uint64_t(c.next) | std::uint64_t(c.acked) << 8 | std::uint64_t(c.inFlight) << 16 |
+               std::uint64_t(c.retries) << 24;
+    };
+
+    auto const alphabet = std::tuple{Ev::Open{}, Ev::Send{}, Ev::Ack{}, Ev::Timeout{}, Ev::Close{}};
+
+    double single = 0;
+    double last = 0;
+    for (auto count : {1u, threads}) {
+        auto const start = std::chrono::steady_clock::now();
+        auto const result = vfsm::explore(
+            Sender::Fsm{Sender::Context{}, Sender::Closed{}}, alphabet, hash,
+            [](Sender::Fsm const& sm, std::size_t) {
+                // Invariants to verify
+                auto const& c = sm.context();
+                return c.inFlight <= Sender::Context::window && c.retries <= Sender::Context::maxRetries + 1;
+            },
+            vfsm::ExploreOptions{.threads = count});
+        auto const stop = std::chrono::steady_clock::now();
+        auto const ms = std::chrono::duration<double, std::milli>(stop - start).count();
+        if (single == 0)
+            single = ms;
+        last = ms;
+
+        std::printf("threads: %2u, configurations: %zu, transitions: %zu, depth: %zu, complete: %s, %.1f ms\n",
+                    count, result.configurations, result.transitions, result.depth,
+                    result.complete ? "yes" : "no", ms);
+
+        if (!result.complete)
+            return 1;
+    }
+
+    // Measured, not assumed: threads over the hardware ones only add the switching
+    std::printf("speedup with %u threads on %u hardware threads: %.2fx\n", threads,
+                std::thread::hardware_concurrency(), single / last);
+
+    return 0;
+}
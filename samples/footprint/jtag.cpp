@@ -0,0 +1,8 @@
+// JTAG TAP controller alone, see size_report.cmake
+
+#include "samples/jtag/jtag.hpp"
+
+bool process(Jtag::Fsm &sm, Ev::Tms event)
+{
+    return sm.processEvent(event);
+}
@@ -0,0 +1,18 @@
+// Motor controller alone, see size_report.cmake
+
+#include "samples/debug_dispatch/motor.hpp"
+
+bool process(Motor::Fsm &sm, Ev::Tick event)
+{
+    return sm.processEvent(event);
+}
+
+bool process(Motor::Fsm &sm, Ev::Command event)
+{
+    return sm.processEvent(event);
+}
+
+bool process(Motor::Fsm &sm, Ev::Stop event)
+{
+    return sm.processEvent(event);
+}
@@ -0,0 +1,118 @@
+#
+# Code size report of the object files by nm symbol sizes:
+#   cmake -DNM=nm -P size_report.cmake <object>...
+#
+# Code of the machine is split by its origin: processEvent<Event> (entry, dispatch and inlined handlers), OnExit/OnEnter
+# (state change), poll(), handler bodies left out of line and the rest. Read-only data (dispatch tables) is summed
+# separately.
+#
+
+if(NOT NM)
+    set(NM nm)
+endif()
+
+# Arguments after the script path
+set(objects)
+math(EXPR last "${CMAKE_ARGC} - 1")
+foreach(i RANGE ${last})
+    if(CMAKE_ARGV${i} STREQUAL "-P")
+        math(EXPR first "${i} + 2")
+    elseif(DEFINED first AND i GREATER_EQUAL first)
+        list(APPEND objects "${CMAKE_ARGV${i}}")
+    endif()
+endforeach()
+
+function(classify name out)
+    if(name MATCHES "handleOnExitEnter<|::exitState\\(|::enterState")
+        set(group "OnExit/OnEnter")
+    elseif(name MATCHES "::dispatchEvent<([^<>]+)>")
+        string(REGEX REPLACE "&+$" "" event "${CMAKE_MATCH_1}")
+        set(group "processEvent<${event}>")
+    elseif(name MATCHES "^process\\(.*, ([^,]+)\\)$")
+        set(group "processEvent<${CMAKE_MATCH_1}>")
+    elseif(name MATCHES "::pollState\\(")
+        set(group "poll()")
+    elseif(name MATCHES "::operator\\(\\)\\(\\)::{lambda\\(([^)]*)\\)#[0-9]+}")
+        set(group "handler (${CMAKE_MATCH_1})")
+    else()
+        string(REGEX REPLACE " \\[clone [^]]*\\]" "" group "${name}")
+        string(LENGTH "${group}" length)
+        if(length GREATER 80)
+            string(SUBSTRING "${group}" 0 77 group)
+            string(APPEND group "...")
+        endif()
+    endif()
+    set(${out} "${group}" PARENT_SCOPE)
+endfunction()
+
+foreach(object ${objects})
+    execute_process(COMMAND ${NM} --demangle --print-size --size-sort --radix=d "${object}"
+                    OUTPUT_VARIABLE symbols
+                    RESULT_VARIABLE result)
+    if(NOT result EQUAL 0)
+        message(FATAL_ERROR "${NM} failed on ${object}")
+    endif()
+
+    # Semicolons of the demangled names would split the list
+    string(REPLACE ";" "\;" symbols "${symbols}")
+    string(REPLACE "\n" ";" symbols "${symbols}")
+
+    set(groups)
+    set(sizes)
+    set(text 0)
+    set(data 0)
+    foreach(line IN LISTS symbols)
+        if(NOT line MATCHES "^[0-9]+ ([0-9]+) ([A-Za-z]) (.*)$")
+            continue()
+        endif()
+        math(EXPR size "${CMAKE_MATCH_1}")
+        set(type "${CMAKE_MATCH_2}")
+        set(name "${CMAKE_MATCH_3}")
+        if(NOT type MATCHES "^[tTwW]$")
+            math(EXPR data "${data} + ${size}")
+            continue()
+        endif()
+        math(EXPR text "${text} + ${size}")
+
+        classify("${name}" group)
+        list(FIND groups "${group}" index)
+        if(index EQUAL -1)
+            list(APPEND groups "${group}")
+            list(APPEND sizes ${size})
+        else()
+            list(GET sizes ${index} total)
+            math(EXPR total "${total} + ${size}")
+            list(REMOVE_AT sizes ${index})
+            list(INSERT sizes ${index} ${total})
+        endif()
+    endforeach()
+
+    # Object library directory is named after the target
+    get_filename_component(label "${object}" DIRECTORY)
+    get_filename_component(label "${label}" NAME)
+    string(REGEX REPLACE "\\.dir$" "" label "${label}")
+
+    set(rows)
+    list(LENGTH groups count)
+    if(count GREATER 0)
+        math(EXPR last "${count} - 1")
+        foreach(i RANGE ${last})
+            list(GET groups ${i} group)
+            list(GET sizes ${i} size)
+            list(APPEND rows "${size}|${group}")
+        endforeach()
+    endif()
+    list(SORT rows COMPARE NATURAL ORDER DESCENDING)
+
+    message("${label}: .text ${text} bytes, read-only data ${data} bytes")
+    foreach(row IN LISTS rows)
+        string(REPLACE "|" ";" row "${row}")
+        list(GET row 0 size)
+        list(GET row 1 group)
+        string(LENGTH "${size}" width)
+        math(EXPR pad "8 - ${width}")
+        string(REPEAT " " ${pad} indent)
+        message("${indent}${size}  ${group}")
+    endforeach()
+    message("")
+endforeach()
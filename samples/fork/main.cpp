@@ -0,0 +1,111 @@
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+
+#include "vfsm/fork_pool.hpp"
+
+namespace Ev {
+struct Packet { std::uint32_t size{}; };
+struct Tick   {};
+}
+
+namespace Admission {
+
+// States
+struct Open      {};
+struct Throttled {};
+struct Blocked   {};
+
+struct Context
+{
+    constexpr auto operator()()
+    {
+        return vfsm::overload {
+            [this](Open,      Ev::Packet ev) -> std::variant<Open, Throttled> { return take(ev.size) ? std::variant<Open, Throttled>{} : Throttled{}; },
+            [this](Throttled, Ev::Packet ev) -> std::variant<Throttled, Blocked> { ++strikes; if (strikes > 3) return Blocked{}; (void)take(ev.size); return {}; },
+            [this](Throttled, Ev::Tick)      -> std::variant<Throttled, Open> { refill(); if (tokens > burst / 2) return Open{}; return {}; },
+            [this](Open,      Ev::Tick)      -> Open { refill(); return {}; },
+            [this](Blocked,   Ev::Tick)      -> std::variant<Blocked, Open> { if (++cooldown == 100) { *this = {}; return Open{}; } return {}; }
+        };
+    }
+
+    constexpr bool take(std::uint32_t size)
+    {
+        if (size > tokens)
+            return false;
+        tokens -= size;
+        return true;
+    }
+
+    constexpr void refill()
+    {
+        tokens = tokens + rate > burst ? burst : tokens + rate;
+    }
+
+    std::uint32_t tokens = 4096;
+    std::uint32_t burst = 4096;
+    std::uint32_t rate = 512;
+    std::uint32_t strikes = 0;
+    std::uint32_t cooldown = 0;
+};
+
+using Fsm = vfsm::Fsm<Context, Open, Throttled, Blocked>;
+
+}
+
+static constexpr std::array<Ev::Packet, 8> burst = {{{700}, {1500}, {64}, {1500}, {900}, {1500}, {300}, {1500}}};
+
+// Would the burst push the machine into Blocked state?
+template <class Machine>
+static bool admit(Machine &probe)
+{
+    for (auto ev : burst)
+        probe.processEvent(ev);
+    return probe.state_index() != 2;
+}
+
+template <class Fn>
+static void measure(char const *name, unsigned count, Fn &&fn)
+{
+    unsigned admitted = 0;
+    auto const start = std::chrono::steady_clock::now();
+    for (unsigned i = 0; i < count; ++i)
+        admitted += fn(i);
+    auto const stop = std::chrono::steady_clock::now();
+    auto const sec = std::chrono::duration<double>(stop - start).count();
+    std::printf("%-28s: %10.0f forks/s, admitted %u\n", name, count / sec, admitted);
+}
+
+int main()
+{
+    constexpr unsigned count = 1'000'000;
+
+    static_assert(std::is_trivially_copyable_v<Admission::Fsm>);
+
+    Admission::Fsm sm{Admission::Context{}, Admission::Open{}};
+    vfsm::ForkPool<Admission::Fsm> pool;
+
+    measure("heap copy (make_unique)", count, [&](unsigned i) {
+        auto probe = std::make_unique<Admission::Fsm>(sm);
+        probe->context().tokens = i % 8192;
+        return admit(*probe);
+    });
+
+    measure("sm.fork()", count, [&](unsigned i) {
+        auto probe = sm.fork();
+        probe.context().tokens = i % 8192;
+        return admit(probe);
+    });
+
+    measure("ForkPool::fork()", count, [&](unsigned i) {
+        auto probe = pool.fork(sm);
+        probe->context().tokens = i % 8192;
+        return admit(*probe);
+    });
+
+    std::printf("pool capacity: %zu, available: %zu\n", pool.capacity(), pool.available());
+
+    return 0;
+}
@@ -0,0 +1,209 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "jtag.hpp"
+#include "shift.hpp"
+#include "tms_path.hpp"
+
+namespace Jtag {
+
+struct DeviceConfig
+{
+    std::size_t   irLength = 4;    // 2..64 bits
+    std::size_t   drLength = 32;   // data register selected by the non-IDCODE, non-BYPASS instruction
+    std::uint32_t idcode = 0x1;
+};
+
+//
+// Daisy-chained TAP controllers: board TDI -> device 0 -> ... -> device N-1 -> board TDO.
+//
+// All devices share TMS, so their TAP state is always identical and is kept by the single Jtag::Fsm stepped in
+// lockstep for the whole chain. Shift paths of the devices are concatenated into the single IR and DR shift registers
+// of that machine, so scans go at the word level through the whole chain; Capture/Update are done per device segment.
+//
+// Instructions: all ones - BYPASS (1-bit DR), 1 - IDCODE (32-bit DR), other - device data register of `drLength`.
+// Test-Logic-Reset selects IDCODE.
+//
+class Chain final : public JtagContext::Target
+{
+public:
+    static constexpr std::uint64_t IdcodeInstruction = 1;
+
+    explicit Chain(std::vector<DeviceConfig> devices)
+        : _devices{std::move(devices)},
+          _instruction(_devices.size()),
+          _irPos(_devices.size()),
+          _drPos(_devices.size()),
+          _dataPos(_devices.size())
+    {
+        // Device closest to the board TDO occupies the lowest bits of the shift path
+        std::size_t irPos = 0, dataPos = 0;
+        for (std::size_t i = _devices.size(); i-- > 0;) {
+            _irPos[i] = irPos;
+            irPos += _devices[i].irLength;
+        }
+        for (std::size_t i = 0; i < _devices.size(); ++i) {
+            _dataPos[i] = dataPos;
+            dataPos += _devices[i].drLength;
+        }
+        _data.assign(dataPos / 64 + 2, 0);
+
+        auto &d = _tap.context().d;
+        d.ir.resize(irPos);
+        d.target = this;
+        reset();
+    }
+
+    Chain(Chain const&) = delete;
+    Chain& operator=(Chain const&) = delete;
+
+    Fsm& tap() noexcept
+    {
+        return _tap;
+    }
+
+    std::size_t size() const noexcept
+    {
+        return _devices.size();
+    }
+
+    // Current total IR and DR lengths of the chain
+    std::size_t irLength() const noexcept
+    {
+        return _tap.context().d.ir.length();
+    }
+
+    std::size_t drLength() const noexcept
+    {
+        std::size_t length = 0;
+        for (std::size_t i = 0; i < _devices.size(); ++i)
+            length += selectedLength(i);
+        return length;
+    }
+
+    // Device segment position in the chain IR
+    std::size_t irOffset(std::size_t device) const noexcept
+    {
+        return _irPos[device];
+    }
+
+    std::uint64_t instruction(std::size_t device) const noexcept
+    {
+        return _instruction[device];
+    }
+
+    // Device data register content (bit vector of `drLength` bits)
+    std::uint64_t dataBits(std::size_t device, std::size_t pos, std::size_t count) const
+    {
+        return getBits(_data.data(), _dataPos[device] + pos, count);
+    }
+
+    // Single TCK on the board pins
+    bool clock(bool tms, bool tdi)
+    {
+        auto &d = _tap.context().d;
+        d.tdi = tdi;
+        _tap.processEvent(Ev::Tms{tms});
+        return d.tdo;
+    }
+
+    // Full IR/DR scan from and to Run-Test/Idle with the bulk shift
+    void scanIr(std::span<std::uint64_t const> tdi, std::span<std::uint64_t> tdo)
+    {
+        scan<ShiftIr>(tdi, tdo, irLength());
+    }
+
+    void scanDr(std::span<std::uint64_t const> tdi, std::span<std::uint64_t> tdo, std::size_t count)
+    {
+        scan<ShiftDr>(tdi, tdo, count);
+    }
+
+    //
+    // JtagContext::Target
+    //
+    void reset() override
+    {
+        std::fill(_instruction.begin(), _instruction.end(), IdcodeInstruction);
+    }
+
+    void captureIr(ShiftRegister &ir) override
+    {
+        // IEEE 1149.1: two least significant captured bits are 01
+        for (std::size_t i = 0; i < _devices.size(); ++i)
+            setBits(ir.data(), _irPos[i], 0b01, _devices[i].irLength);
+    }
+
+    void updateIr(ShiftRegister const& ir) override
+    {
+        for (std::size_t i = 0; i < _devices.size(); ++i)
+            _instruction[i] = getBits(ir.data(), _irPos[i], _devices[i].irLength);
+    }
+
+    void captureDr(ShiftRegister &dr) override
+    {
+        dr.resize(drLength());
+
+        std::size_t pos = 0;
+        for (std::size_t i = _devices.size(); i-- > 0;) {
+            _drPos[i] = pos;
+            auto const length = selectedLength(i);
+            if (isIdcode(i))
+                setBits(dr.data(), pos, _devices[i].idcode, 32);
+            else if (!isBypass(i))
+                copyBits(dr.data(), pos, _data.data(), _dataPos[i], length);
+            pos += length;
+        }
+    }
+
+    void updateDr(ShiftRegister const& dr) override
+    {
+        for (std::size_t i = 0; i < _devices.size(); ++i) {
+            if (!isIdcode(i) && !isBypass(i))
+                copyBits(_data.data(), _dataPos[i], dr.data(), _drPos[i], _devices[i].drLength);
+        }
+    }
+
+private:
+    bool isBypass(std::size_t device) const noexcept
+    {
+        auto const length = _devices[device].irLength;
+        auto const ones = length < 64 ? (std::uint64_t(1) << length) - 1 : ~std::uint64_t(0);
+        return _instruction[device] == ones;
+    }
+
+    bool isIdcode(std::size_t device) const noexcept
+    {
+        return _instruction[device] == IdcodeInstruction;
+    }
+
+    std::size_t selectedLength(std::size_t device) const noexcept
+    {
+        if (isBypass(device))
+            return 1;
+        if (isIdcode(device))
+            return 32;
+        return _devices[device].drLength;
+    }
+
+    template <class ShiftState>
+    void scan(std::span<std::uint64_t const> tdi, std::span<std::uint64_t> tdo, std::size_t count)
+    {
+        moveTo<ShiftState>(_tap);
+        shift(_tap, tdi, tdo, count);
+        moveTo<Idle>(_tap);
+    }
+
+private:
+    std::vector<DeviceConfig>  _devices;
+    std::vector<std::uint64_t> _instruction;
+    std::vector<std::size_t>   _irPos;   // device segment in the chain IR
+    std::vector<std::size_t>   _drPos;   // device segment in the chain DR, valid after Capture-DR
+    std::vector<std::size_t>   _dataPos; // device data register in the `_data`
+    std::vector<std::uint64_t> _data;
+    Fsm                        _tap{JtagContext{}, Reset{}};
+};
+
+} // Jtag
@@ -0,0 +1,99 @@
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include "chain.hpp"
+
+static int check(bool ok, char const *what)
+{
+    if (!ok)
+        std::fprintf(stderr, "FAILED: %s\n", what);
+    return ok ? 0 : 1;
+}
+
+int main(int argc, char *argv[])
+{
+    std::size_t const count = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 4096;
+    std::size_t const target = count / 3;
+
+    std::vector<Jtag::DeviceConfig> devices(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        devices[i].irLength = 4 + i % 5;
+        devices[i].drLength = 16 + (i * 37) % 300;
+        devices[i].idcode = std::uint32_t(i << 12 | 0x0ab) | 1;
+    }
+
+    Jtag::Chain chain{devices};
+    auto &tap = chain.tap();
+
+    auto words = [](std::size_t bits) { return std::vector<std::uint64_t>((bits + 63) / 64); };
+
+    //
+    // After Test-Logic-Reset all devices select IDCODE: read the whole chain
+    //
+    Jtag::moveTo<Jtag::Reset>(tap);
+    Jtag::moveTo<Jtag::Idle>(tap);
+
+    auto const idBits = chain.drLength();
+    auto zeros = words(idBits), ids = words(idBits);
+
+    auto const t0 = std::chrono::steady_clock::now();
+    constexpr unsigned rounds = 200;
+    for (unsigned r = 0; r < rounds; ++r)
+        chain.scanDr(zeros, ids, idBits);
+    auto const t1 = std::chrono::steady_clock::now();
+
+    int failed = check(idBits == 32 * count, "IDCODE chain length");
+    for (std::size_t i = 0; i < count; ++i) {
+        auto const pos = 32 * (count - 1 - i);
+        failed += check(Jtag::getBits(ids.data(), pos, 32) == devices[i].idcode, "IDCODE value");
+    }
+
+    //
+    // Select the data register of the one device, bypass others
+    //
+    auto ir = words(chain.irLength()), irOut = words(chain.irLength());
+    for (std::size_t i = 0; i < count; ++i) {
+        auto const len = devices[i].irLength;
+        Jtag::setBits(ir.data(), chain.irOffset(i), i == target ? 2 : (std::uint64_t(1) << len) - 1, len);
+    }
+    chain.scanIr(ir, irOut);
+
+    for (std::size_t i = 0; i < count; ++i)
+        failed += check(Jtag::getBits(irOut.data(), chain.irOffset(i), 2) == 0b01, "IR capture pattern");
+    failed += check(chain.instruction(target) == 2, "target instruction");
+
+    // Bypassed devices after the target delay its segment by one bit each
+    auto const drBits = chain.drLength();
+    auto const targetLength = devices[target].drLength;
+    auto const targetPos = count - 1 - target;
+    failed += check(drBits == count - 1 + targetLength, "bypass chain length");
+
+    auto dr = words(drBits), drOut = words(drBits);
+    for (std::size_t pos = 0; pos < targetLength; pos += 64) {
+        auto const n = std::min<std::size_t>(64, targetLength - pos);
+        Jtag::setBits(dr.data(), targetPos + pos, 0x0123456789abcdefull * (pos + 1), n);
+    }
+    chain.scanDr(dr, drOut, drBits);
+    for (std::size_t pos = 0; pos < targetLength; pos += 64) {
+        auto const n = std::min<std::size_t>(64, targetLength - pos);
+        failed += check(chain.dataBits(target, pos, n) == Jtag::getBits(dr.data(), targetPos + pos, n),
+                        "target data register update");
+    }
+
+    // Read it back, zeros are written
+    chain.scanDr(zeros, drOut, drBits);
+    for (std::size_t pos = 0; pos < targetLength; pos += 64) {
+        auto const n = std::min<std::size_t>(64, targetLength - pos);
+        failed += check(Jtag::getBits(drOut.data(), targetPos + pos, n) == Jtag::getBits(dr.data(), targetPos + pos, n),
+                        "target data register capture");
+        failed += check(chain.dataBits(target, pos, n) == 0, "target data register cleared");
+    }
+
+    auto const sec = std::chrono::duration<double>(t1 - t0).count();
+    std::printf("devices: %zu, IDCODE scan of %zu bits: %.1f scans/s, %.1f Mbit/s\n",
+                count, idBits, rounds / sec, double(idBits) * rounds / sec / 1e6);
+
+    return failed ? 1 : 0;
+}
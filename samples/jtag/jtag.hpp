@@ -0,0 +1,111 @@
+#pragma once
+
+#include "vfsm/reachable.hpp"
+#include "vfsm/vfsm.hpp"
+
+#include "shift_register.hpp"
+
+namespace Ev {
+struct Tms { bool val{}; using Domain = vfsm::Domain<&Tms::val>; };
+}
+
+namespace Jtag {
+
+// States
+struct Reset        {};
+struct Idle         {};
+struct SelectDrScan {};
+struct SelectIrScan {};
+//
+struct CaptureDr    {};
+struct ShiftDr      {};
+struct Exit1Dr      {};
+struct PauseDr      {};
+struct Exit2Dr      {};
+struct UpdateDr     {};
+//
+struct CaptureIr    {};
+struct ShiftIr      {};
+struct Exit1Ir      {};
+struct PauseIr      {};
+struct Exit2Ir      {};
+struct UpdateIr     {};
+
+
+struct JtagContext
+{
+    // Jtag transition table. TAP moves are pure and precomputed per TMS value, only Shift states touch the registers.
+    constexpr auto operator()()
+    {
+        return vfsm::overload{
+            vfsm::pure([](Reset,        Ev::Tms ev) -> std::variant<Reset, Idle>             { if (ev.val) return {}; return Idle{}; }),
+            vfsm::pure([](Idle,         Ev::Tms ev) -> std::variant<SelectDrScan, Idle>      { if (ev.val) return {}; return Idle{}; }),
+            // DR
+            vfsm::pure([](SelectDrScan, Ev::Tms ev) -> std::variant<SelectIrScan, CaptureDr> { if (ev.val) return {}; return CaptureDr{}; }),
+            vfsm::pure([](CaptureDr,    Ev::Tms ev) -> std::variant<Exit1Dr, ShiftDr>        { if (ev.val) return {}; return ShiftDr{}; }),
+                   [this](ShiftDr,      Ev::Tms ev) -> std::variant<Exit1Dr, ShiftDr>        { feedDrBit(); if (ev.val) return {}; return ShiftDr{}; },
+            vfsm::pure([](Exit1Dr,      Ev::Tms ev) -> std::variant<UpdateDr, PauseDr>       { if (ev.val) return {}; return PauseDr{}; }),
+            vfsm::pure([](PauseDr,      Ev::Tms ev) -> std::variant<Exit2Dr, PauseDr>        { if (ev.val) return {}; return PauseDr{}; }),
+            vfsm::pure([](Exit2Dr,      Ev::Tms ev) -> std::variant<UpdateDr, ShiftDr>       { if (ev.val) return {}; return ShiftDr{}; }),
+            vfsm::pure([](UpdateDr,     Ev::Tms ev) -> std::variant<SelectDrScan, Idle>      { if (ev.val) return {}; return Idle{}; }),
+            // IR
+            vfsm::pure([](SelectIrScan, Ev::Tms ev) -> std::variant<Reset, CaptureIr>        { if (ev.val) return {}; return CaptureIr{}; }),
+            vfsm::pure([](CaptureIr,    Ev::Tms ev) -> std::variant<Exit1Ir, ShiftIr>        { if (ev.val) return {}; return ShiftIr{}; }),
+                   [this](ShiftIr,      Ev::Tms ev) -> std::variant<Exit1Ir, ShiftIr>        { feedIrBit(); if (ev.val) return {}; return ShiftIr{}; },
+            vfsm::pure([](Exit1Ir,      Ev::Tms ev) -> std::variant<UpdateIr, PauseIr>       { if (ev.val) return {}; return PauseIr{}; }),
+            vfsm::pure([](PauseIr,      Ev::Tms ev) -> std::variant<Exit2Ir, PauseIr>        { if (ev.val) return {}; return PauseIr{}; }),
+            vfsm::pure([](Exit2Ir,      Ev::Tms ev) -> std::variant<UpdateIr, ShiftIr>       { if (ev.val) return {}; return ShiftIr{}; }),
+            vfsm::pure([](UpdateIr,     Ev::Tms ev) -> std::variant<SelectDrScan, Idle>      { if (ev.val) return {}; return Idle{}; }),
+
+            // Device model: parallel load and latch of the registers
+            [this](Reset,        vfsm::OnEnter) { if (d.target) d.target->reset(); },
+            [this](CaptureDr,    vfsm::OnEnter) { if (d.target) d.target->captureDr(d.dr); },
+            [this](UpdateDr,     vfsm::OnEnter) { if (d.target) d.target->updateDr(d.dr); },
+            [this](CaptureIr,    vfsm::OnEnter) { if (d.target) d.target->captureIr(d.ir); },
+            [this](UpdateIr,     vfsm::OnEnter) { if (d.target) d.target->updateIr(d.ir); }
+        };
+    }
+
+    // Every TCK in the Shift state shifts the bit, including the exiting one with TMS=1
+    constexpr void feedDrBit()
+    {
+        d.tdo = d.dr.shift(d.tdi);
+    }
+
+    constexpr void feedIrBit()
+    {
+        d.tdo = d.ir.shift(d.tdi);
+    }
+
+    // Optional device model behind the shift registers. Without it registers just loop shifted data back.
+    struct Target
+    {
+        virtual ~Target() = default;
+        virtual void reset() = 0;
+        virtual void captureDr(ShiftRegister &dr) = 0;
+        virtual void updateDr(ShiftRegister const& dr) = 0;
+        virtual void captureIr(ShiftRegister &ir) = 0;
+        virtual void updateIr(ShiftRegister const& ir) = 0;
+    };
+
+    // Simulated device: TDI/TDO pins and registers
+    struct Data
+    {
+        bool          tdi = false;
+        bool          tdo = false;
+        ShiftRegister dr{32};
+        ShiftRegister ir{8};
+        Target       *target = nullptr;
+    };
+    Data d;
+};
+
+// Every TAP state is entered from Test-Logic-Reset by TMS only
+using Fsm = vfsm::ReachableFsm<JtagContext, std::tuple<Ev::Tms>, Reset,
+                               Reset, Idle,
+                               SelectDrScan, CaptureDr, ShiftDr, Exit1Dr, PauseDr, Exit2Dr, UpdateDr,
+                               SelectIrScan, CaptureIr, ShiftIr, Exit1Ir, PauseIr, Exit2Ir, UpdateIr>;
+
+static_assert(Fsm::state_count == 16, "TAP controller has 16 states");
+
+} // Jtag
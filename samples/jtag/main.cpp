@@ -1,81 +1,103 @@
+#include <chrono>
+#include <cstdint>
 #include <iostream>
+#include <random>
+#include <vector>
 
-#include "vfsm/vfsm.hpp"
+#include "jtag.hpp"
+#include "shift.hpp"
+#include "tms_path.hpp"
 
 using namespace std;
 
-namespace Ev {
-struct Tms { bool val{}; };
+// Well-known sequences from IEEE 1149.1, TMS bits are sent LSB first
+static_assert(Jtag::tmsPath<Jtag::Reset, Jtag::Idle>().length == 1);
+static_assert(Jtag::tmsPath<Jtag::Idle,  Jtag::ShiftDr>().bits == 0b001 && Jtag::tmsPath<Jtag::Idle, Jtag::ShiftDr>().length == 3);
+static_assert(Jtag::tmsPath<Jtag::Idle,  Jtag::ShiftIr>().bits == 0b0011 && Jtag::tmsPath<Jtag::Idle, Jtag::ShiftIr>().length == 4);
+static_assert(Jtag::tmsPath<Jtag::Exit1Dr, Jtag::Idle>().bits == 0b01 && Jtag::tmsPath<Jtag::Exit1Dr, Jtag::Idle>().length == 2);
+static_assert(Jtag::tmsPath<Jtag::ShiftIr, Jtag::Reset>().bits == 0b11111 && Jtag::tmsPath<Jtag::ShiftIr, Jtag::Reset>().length == 5);
+
+// The machine itself at compile time: 32-bit DR word goes through the register and leaves it 32 TCKs later
+constexpr std::uint32_t shiftDrThrough(std::uint32_t word)
+{
+    Jtag::Fsm sm{Jtag::JtagContext{}, Jtag::Reset{}};
+    Jtag::moveTo<Jtag::ShiftDr>(sm);
+
+    std::uint32_t out = 0;
+    for (unsigned i = 0; i < 64; ++i) {
+        sm.context().d.tdi = i < 32 && ((word >> i) & 1);
+        sm.processEvent(Ev::Tms{i == 63});
+        if (i >= 32)
+            out |= std::uint32_t(sm.context().d.tdo) << (i - 32);
+    }
+    Jtag::moveTo<Jtag::Idle>(sm);
+    return sm.state_index() == Jtag::Fsm::index_of<Jtag::Idle>() ? out : 0;
 }
 
-namespace Jtag {
-
-// States
-struct Reset        {};
-struct Idle         {};
-struct SelectDrScan {};
-struct SelectIrScan {};
-//
-struct CaptureDr    {};
-struct ShiftDr      {};
-struct Exit1Dr      {};
-struct PauseDr      {};
-struct Exit2Dr      {};
-struct UpdateDr     {};
-//
-struct CaptureIr    {};
-struct ShiftIr      {};
-struct Exit1Ir      {};
-struct PauseIr      {};
-struct Exit2Ir      {};
-struct UpdateIr     {};
-
-
-struct JtagContext
+static_assert(shiftDrThrough(0xdeadbeef) == 0xdeadbeef);
+
+int main()
 {
-    // Jtag transition table
-    constexpr auto operator()()
-    {
-        return vfsm::overload{
-            [    ](Reset,        Ev::Tms ev) -> std::variant<Reset, Idle>             { if (ev.val) return {}; return Idle{}; },
-            [    ](Idle,         Ev::Tms ev) -> std::variant<SelectDrScan, Idle>      { if (ev.val) return {}; return Idle{}; },
-            // DR
-            [    ](SelectDrScan, Ev::Tms ev) -> std::variant<SelectIrScan, CaptureDr> { if (ev.val) return {}; return CaptureDr{}; },
-            [    ](CaptureDr,    Ev::Tms ev) -> std::variant<Exit1Dr, ShiftDr>        { if (ev.val) return {}; return ShiftDr{}; },
-            [this](ShiftDr,      Ev::Tms ev) -> std::variant<Exit1Dr, ShiftDr>        { if (ev.val) return {}; feedDrBit(); return ShiftDr{}; },
-            [    ](Exit1Dr,      Ev::Tms ev) -> std::variant<UpdateDr, PauseDr>       { if (ev.val) return {}; return PauseDr{}; },
-            [    ](PauseDr,      Ev::Tms ev) -> std::variant<Exit2Dr, PauseDr>        { if (ev.val) return {}; return PauseDr{}; },
-            [    ](Exit2Dr,      Ev::Tms ev) -> std::variant<UpdateDr, ShiftDr>       { if (ev.val) return {}; return ShiftDr{}; },
-            [    ](UpdateDr,     Ev::Tms ev) -> std::variant<SelectDrScan, Idle>      { if (ev.val) return {}; return Idle{}; },
-            // IR
-            [    ](SelectIrScan, Ev::Tms ev) -> std::variant<Reset, CaptureIr>        { if (ev.val) return {}; return CaptureIr{}; },
-            [    ](CaptureIr,    Ev::Tms ev) -> std::variant<Exit1Ir, ShiftIr>        { if (ev.val) return {}; return ShiftIr{}; },
-            [this](ShiftIr,      Ev::Tms ev) -> std::variant<Exit1Ir, ShiftIr>        { if (ev.val) return {}; feedIrBit(); return ShiftIr{}; },
-            [    ](Exit1Ir,      Ev::Tms ev) -> std::variant<UpdateIr, PauseIr>       { if (ev.val) return {}; return PauseIr{}; },
-            [    ](PauseIr,      Ev::Tms ev) -> std::variant<Exit2Ir, PauseIr>        { if (ev.val) return {}; return PauseIr{}; },
-            [    ](Exit2Ir,      Ev::Tms ev) -> std::variant<UpdateIr, ShiftIr>       { if (ev.val) return {}; return ShiftIr{}; },
-            [    ](UpdateIr,     Ev::Tms ev) -> std::variant<SelectDrScan, Idle>      { if (ev.val) return {}; return Idle{}; }
-        };
+    Jtag::Fsm sm{Jtag::JtagContext{}, Jtag::Reset{}};
+
+    // Walk every (from, to) pair by the precomputed paths and check the arrival
+    for (std::size_t from = 0; from < Jtag::Fsm::state_count; ++from) {
+        for (std::size_t to = 0; to < Jtag::Fsm::state_count; ++to) {
+            Jtag::moveTo(sm, from);
+            Jtag::moveTo(sm, to);
+            if (sm.state_index() != to) {
+                cerr << "TMS path " << from << " -> " << to << " failed\n";
+                return 1;
+            }
+        }
+    }
+
+    cout << "TMS paths (length:bits) from row to column state\n";
+    for (auto const& row : Jtag::tmsPaths) {
+        for (auto const& path : row)
+            cout << unsigned(path.length) << ':' << hex << unsigned(path.bits) << dec << ' ';
+        cout << '\n';
     }
 
-    void feedDrBit()
-    {}
+    //
+    // DR shifting: per-bit dispatch vs bulk word-level shift
+    //
+    constexpr std::size_t bits = 8 * 1024 * 1024;
 
-    void feedIrBit()
-    {}
+    std::vector<std::uint64_t> tdi(bits / 64);
+    std::mt19937_64 rng{42};
+    for (auto &w : tdi)
+        w = rng();
 
-    struct Data {};
-    Data d;
-};
+    std::vector<std::uint64_t> tdoBits(bits / 64), tdoBulk(bits / 64);
 
-using Fsm = vfsm::Fsm<JtagContext,
-                      Reset, Idle,
-                      SelectDrScan, CaptureDr, ShiftDr, Exit1Dr, PauseDr, Exit2Dr, UpdateDr,
-                      SelectIrScan, CaptureIr, ShiftIr, Exit1Ir, PauseIr, Exit1Ir, UpdateIr>;
+    auto const t0 = chrono::steady_clock::now();
+    Jtag::moveTo<Jtag::ShiftDr>(sm);
+    for (std::size_t i = 0; i < bits; ++i) {
+        sm.context().d.tdi = Jtag::getBit(tdi.data(), i);
+        sm.processEvent(Ev::Tms{i + 1 == bits});
+        Jtag::setBit(tdoBits.data(), i, sm.context().d.tdo);
+    }
+    Jtag::moveTo<Jtag::Idle>(sm);
 
-}
+    auto const t1 = chrono::steady_clock::now();
+    Jtag::moveTo<Jtag::ShiftDr>(sm);
+    Jtag::shift(sm, tdi, tdoBulk, bits);
+    Jtag::moveTo<Jtag::Idle>(sm);
+    auto const t2 = chrono::steady_clock::now();
+
+    auto const mbps = [](auto dt) { return double(bits) / chrono::duration<double, std::micro>(dt).count(); };
+    cout << "DR shift of " << bits << " bits: per-bit " << mbps(t1 - t0) << " Mbit/s, bulk " << mbps(t2 - t1) << " Mbit/s\n";
+
+    // TDO is TDI delayed by the DR length, second pass starts with the tail of the first one
+    auto const len = sm.context().d.dr.length();
+    for (std::size_t i = 0; i < bits; ++i) {
+        auto const expected = Jtag::getBit(tdi.data(), (i + bits - len) % bits);
+        if ((i >= len && Jtag::getBit(tdoBits.data(), i) != expected) || Jtag::getBit(tdoBulk.data(), i) != expected) {
+            cerr << "DR shift mismatch at bit " << i << '\n';
+            return 1;
+        }
+    }
 
-int main()
-{
     return 0;
 }
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+
+#include "jtag.hpp"
+
+namespace Jtag {
+
+//
+// Bulk DR/IR shift: `count` bits of `tdi` are shifted through the register selected by the current Shift state at the
+// word level, TDO is captured into `tdo` (may be empty). With `exit` the last bit is clocked through the machine with
+// TMS=1, leaving it in the Exit1Dr/Exit1Ir state, otherwise the machine stays in the Shift state.
+//
+// Returns false if machine is not in the ShiftDr/ShiftIr state.
+//
+inline bool shift(Fsm &sm, std::span<std::uint64_t const> tdi, std::span<std::uint64_t> tdo, std::size_t count,
+                  bool exit = true)
+{
+    auto &d = sm.context().d;
+
+    ShiftRegister *reg = nullptr;
+    if (sm.state_index() == Fsm::index_of<ShiftDr>())
+        reg = &d.dr;
+    else if (sm.state_index() == Fsm::index_of<ShiftIr>())
+        reg = &d.ir;
+
+    if (!reg || tdi.size() * 64 < count || (!tdo.empty() && tdo.size() * 64 < count))
+        return false;
+    if (count == 0)
+        return true;
+
+    auto const bulk = exit ? count - 1 : count;
+    reg->shift(tdi.data(), tdo.empty() ? nullptr : tdo.data(), bulk);
+
+    if (exit) {
+        d.tdi = getBit(tdi.data(), count - 1);
+        sm.processEvent(Ev::Tms{true});
+        if (!tdo.empty())
+            setBit(tdo.data(), count - 1, d.tdo);
+    }
+
+    return true;
+}
+
+} // Jtag
@@ -0,0 +1,136 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Jtag {
+
+//
+// Bit vector helpers, bit `i` is `(words[i / 64] >> (i % 64)) & 1`
+//
+constexpr bool getBit(std::uint64_t const *words, std::size_t pos)
+{
+    return ((words[pos / 64] >> (pos % 64)) & 1) != 0;
+}
+
+constexpr void setBit(std::uint64_t *words, std::size_t pos, bool value)
+{
+    auto const mask = std::uint64_t(1) << (pos % 64);
+    words[pos / 64] = value ? (words[pos / 64] | mask) : (words[pos / 64] & ~mask);
+}
+
+// Up to 64 bits starting from `pos`, bits over `count` are zero
+constexpr std::uint64_t getBits(std::uint64_t const *words, std::size_t pos, std::size_t count)
+{
+    auto const word = pos / 64;
+    auto const shift = pos % 64;
+    std::uint64_t value = words[word] >> shift;
+    if (shift && shift + count > 64)
+        value |= words[word + 1] << (64 - shift);
+    return count < 64 ? value & ((std::uint64_t(1) << count) - 1) : value;
+}
+
+// Up to 64 bits starting from `pos`, other bits are kept
+constexpr void setBits(std::uint64_t *words, std::size_t pos, std::uint64_t value, std::size_t count)
+{
+    auto const word = pos / 64;
+    auto const shift = pos % 64;
+    auto const mask = count < 64 ? (std::uint64_t(1) << count) - 1 : ~std::uint64_t(0);
+    value &= mask;
+    words[word] = (words[word] & ~(mask << shift)) | (value << shift);
+    if (shift && shift + count > 64) {
+        words[word + 1] = (words[word + 1] & ~(mask >> (64 - shift))) | (value >> (64 - shift));
+    }
+}
+
+// Copy `count` bits word by word. Overlapped copy is allowed only towards lower positions with word-aligned `dstPos`
+constexpr void copyBits(std::uint64_t *dst, std::size_t dstPos, std::uint64_t const *src, std::size_t srcPos,
+                        std::size_t count)
+{
+    while (count) {
+        auto const chunk = std::min<std::size_t>(count, 64);
+        setBits(dst, dstPos, getBits(src, srcPos, chunk), chunk);
+        dstPos += chunk;
+        srcPos += chunk;
+        count -= chunk;
+    }
+}
+
+//
+// TAP data/instruction register model: TDI enters at the most significant bit, TDO leaves from the bit 0.
+//
+class ShiftRegister
+{
+public:
+    constexpr explicit ShiftRegister(std::size_t length = 1)
+        : _length{length},
+          _words((length + 63) / 64 + 1)
+    {}
+
+    constexpr std::size_t length() const noexcept
+    {
+        return _length;
+    }
+
+    // New length, content is cleared
+    constexpr void resize(std::size_t length)
+    {
+        _length = length;
+        _words.assign((length + 63) / 64 + 1, 0);
+    }
+
+    // Parallel access to the register content, e.g. for Capture/Update
+    constexpr std::uint64_t* data() noexcept
+    {
+        return _words.data();
+    }
+
+    constexpr std::uint64_t const* data() const noexcept
+    {
+        return _words.data();
+    }
+
+    // Single TCK in the Shift state
+    constexpr bool shift(bool tdi)
+    {
+        auto const tdo = getBit(_words.data(), 0);
+        auto const words = (_length + 63) / 64;
+        for (std::size_t i = 0; i + 1 < words; ++i)
+            _words[i] = (_words[i] >> 1) | (_words[i + 1] << 63);
+        _words[words - 1] >>= 1;
+        setBit(_words.data(), _length - 1, tdi);
+        return tdo;
+    }
+
+    //
+    // `count` TCKs in the Shift state at once. `tdi` provides `count` bits, `tdo` (optional) receives `count` bits.
+    //
+    // Register behaves as FIFO: output is the register content followed by the delayed input, new content is the last
+    // `length` bits of the input stream.
+    //
+    constexpr void shift(std::uint64_t const *tdi, std::uint64_t *tdo, std::size_t count)
+    {
+        auto const reg = _words.data();
+        if (count >= _length) {
+            if (tdo) {
+                copyBits(tdo, 0, reg, 0, _length);
+                copyBits(tdo, _length, tdi, 0, count - _length);
+            }
+            copyBits(reg, 0, tdi, count - _length, _length);
+        } else {
+            if (tdo)
+                copyBits(tdo, 0, reg, 0, count);
+            copyBits(reg, 0, reg, count, _length - count);
+            copyBits(reg, _length - count, tdi, 0, count);
+        }
+    }
+
+private:
+    std::size_t _length;
+    // One extra word keeps two-word accesses of the bit helpers in bounds
+    std::vector<std::uint64_t> _words;
+};
+
+} // Jtag
@@ -0,0 +1,523 @@
+#pragma once
+
+#include <array>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <span>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "jtag.hpp"
+#include "shift.hpp"
+#include "tms_path.hpp"
+
+namespace Svf {
+
+//
+// Background chunked file reader: I/O of the next chunks overlaps with parsing and execution of the current one
+//
+class ChunkReader
+{
+public:
+    explicit ChunkReader(std::FILE *file, std::size_t chunkSize = 1 << 20, std::size_t depth = 4)
+        : _buffers(depth, std::vector<char>(chunkSize))
+    {
+        for (std::size_t i = 0; i < depth; ++i)
+            _free.push_back(i);
+
+        _thread = std::jthread([this, file](std::stop_token stop) {
+            while (!stop.stop_requested()) {
+                std::size_t index;
+                {
+                    std::unique_lock lock{_lock};
+                    _cond.wait(lock, [&] { return !_free.empty() || stop.stop_requested(); });
+                    if (stop.stop_requested())
+                        return;
+                    index = _free.front();
+                    _free.pop_front();
+                }
+
+                auto &buf = _buffers[index];
+                auto const size = std::fread(buf.data(), 1, buf.size(), file);
+                // Short read is either the end of file or the error, the partial chunk is dropped on the latter
+                auto const failed = std::ferror(file) != 0;
+
+                {
+                    std::lock_guard lock{_lock};
+                    _filled.push_back({index, failed ? 0 : size});
+                    _failed = failed;
+                }
+                _cond.notify_all();
+
+                if (size == 0 || failed)
+                    return;
+            }
+        });
+    }
+
+    ~ChunkReader()
+    {
+        {
+            std::lock_guard lock{_lock};
+            _thread.request_stop();
+        }
+        _cond.notify_all();
+    }
+
+    // Next chunk of the file, empty one on the end of file or on the read error. Previous chunk is invalidated.
+    std::span<char const> next()
+    {
+        std::unique_lock lock{_lock};
+        if (_current != npos) {
+            _free.push_back(_current);
+            _current = npos;
+            _cond.notify_all();
+        }
+
+        _cond.wait(lock, [&] { return !_filled.empty(); });
+        auto const [index, size] = _filled.front();
+        if (size == 0)
+            return {};
+        _filled.pop_front();
+        _current = index;
+        return {_buffers[index].data(), size};
+    }
+
+    // Reading stopped by the error, not by the end of file
+    bool failed()
+    {
+        std::lock_guard lock{_lock};
+        return _failed;
+    }
+
+private:
+    static constexpr std::size_t npos = ~std::size_t(0);
+
+    struct Filled
+    {
+        std::size_t index;
+        std::size_t size;
+    };
+
+    std::vector<std::vector<char>> _buffers;
+    std::deque<std::size_t>        _free;
+    std::deque<Filled>             _filled;
+    std::size_t                    _current = npos;
+    bool                           _failed = false;
+    std::mutex                     _lock;
+    std::condition_variable        _cond;
+    std::jthread                   _thread;
+};
+
+struct Token
+{
+    std::string text;
+    bool        data = false; // content of the parentheses: hex digits only
+};
+
+//
+// Incremental SVF tokenizer: chunks may split tokens and comments at any place, every complete `...;` command is
+// passed to the handler as the list of tokens.
+//
+class Parser
+{
+public:
+    template <class Handler>
+    bool feed(std::span<char const> chunk, Handler &&handler)
+    {
+        auto p = chunk.data();
+        auto const end = p + chunk.size();
+
+        while (p != end) {
+            if (_paren) {
+                // Bulk data: append runs of the non-space characters up to the closing parenthesis
+                auto const close = static_cast<char const*>(std::memchr(p, ')', std::size_t(end - p)));
+                auto const stop = close ? close : end;
+                auto &data = _tokens[_count - 1].text;
+                while (p != stop) {
+                    auto run = p;
+                    while (run != stop && !isSpace(*run))
+                        ++run;
+                    data.append(p, run);
+                    p = run;
+                    while (p != stop && isSpace(*p))
+                        ++p;
+                }
+                if (close) {
+                    _paren = false;
+                    ++p;
+                }
+                continue;
+            }
+
+            auto const c = *p++;
+
+            if (_comment) {
+                if (c == '\n' || c == '\r')
+                    _comment = false;
+                continue;
+            }
+
+            if (_slash) {
+                _slash = false;
+                if (c == '/') {
+                    flushWord();
+                    _comment = true;
+                    continue;
+                }
+                _word.push_back('/');
+            }
+
+            switch (c) {
+                case '!':
+                    flushWord();
+                    _comment = true;
+                    break;
+                case '/':
+                    _slash = true;
+                    break;
+                case '(':
+                    flushWord();
+                    push(true);
+                    _paren = true;
+                    break;
+                case ';':
+                    flushWord();
+                    if (_count && !handler(std::span<Token const>{_tokens.data(), _count}))
+                        return false;
+                    _count = 0;
+                    break;
+                default:
+                    if (isSpace(c))
+                        flushWord();
+                    else
+                        _word.push_back(c);
+            }
+        }
+        return true;
+    }
+
+    /**
+     * End of the input: false when the last command is not terminated by `;`
+     */
+    bool finish() const noexcept
+    {
+        return _count == 0 && _word.empty() && !_paren && !_slash;
+    }
+
+private:
+    static bool isSpace(char c)
+    {
+        return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+    }
+
+    // Reuse token strings capacity between commands
+    Token& push(bool data)
+    {
+        if (_count == _tokens.size())
+            _tokens.emplace_back();
+        auto &token = _tokens[_count++];
+        token.text.clear();
+        token.data = data;
+        return token;
+    }
+
+    // Keywords are case-insensitive
+    void flushWord()
+    {
+        if (_word.empty())
+            return;
+        for (auto &c : _word) {
+            if (c >= 'a' && c <= 'z')
+                c = char(c - 'a' + 'A');
+        }
+        push(false).text.swap(_word);
+        _word.clear();
+    }
+
+private:
+    std::vector<Token> _tokens;
+    std::size_t        _count = 0;
+    std::string        _word;
+    bool               _comment = false;
+    bool               _paren = false;
+    bool               _slash = false;
+};
+
+struct Stats
+{
+    std::size_t commands = 0;
+    std::size_t tck = 0;
+    std::size_t shiftedBits = 0;
+    std::size_t tdoMismatches = 0;
+};
+
+//
+// SVF executor over the Jtag::Fsm: SIR, SDR, RUNTEST, STATE, ENDIR, ENDDR. FREQUENCY and TRST are accepted and
+// ignored, HIR/HDR/TIR/TDR are accepted with zero length only.
+//
+class Player
+{
+public:
+    explicit Player(Jtag::Fsm &sm)
+        : _sm{sm}
+    {}
+
+    bool execute(std::span<Token const> cmd)
+    {
+        ++_stats.commands;
+
+        auto const& op = cmd[0].text;
+        if (op == "SIR")
+            return scan(cmd, _ir, Jtag::Fsm::index_of<Jtag::ShiftIr>(), _endIr);
+        if (op == "SDR")
+            return scan(cmd, _dr, Jtag::Fsm::index_of<Jtag::ShiftDr>(), _endDr);
+        if (op == "RUNTEST")
+            return runTest(cmd);
+        if (op == "STATE") {
+            for (std::size_t i = 1; i < cmd.size(); ++i) {
+                auto const state = stateIndex(cmd[i].text);
+                if (state == npos)
+                    return fail("unknown state " + cmd[i].text);
+                _stats.tck += Jtag::moveTo(_sm, state);
+            }
+            return true;
+        }
+        if (op == "ENDIR" || op == "ENDDR") {
+            auto const state = cmd.size() == 2 ? stateIndex(cmd[1].text) : npos;
+            if (state == npos)
+                return fail(op + ": bad state");
+            (op == "ENDIR" ? _endIr : _endDr) = state;
+            return true;
+        }
+        if (op == "HIR" || op == "HDR" || op == "TIR" || op == "TDR") {
+            if (cmd.size() < 2 || cmd[1].text != "0")
+                return fail(op + ": non-zero header/trailer is not supported");
+            return true;
+        }
+        if (op == "FREQUENCY" || op == "TRST")
+            return true;
+
+        return fail("unsupported command " + op);
+    }
+
+    Stats const& stats() const noexcept
+    {
+        return _stats;
+    }
+
+    std::string const& error() const noexcept
+    {
+        return _error;
+    }
+
+private:
+    static constexpr std::size_t npos = ~std::size_t(0);
+
+    // Sticky parameters of the SIR/SDR
+    struct ScanParams
+    {
+        std::size_t length = 0;
+        std::vector<std::uint64_t> tdi, mask, smask;
+        std::vector<std::uint64_t> tdo, captured;
+    };
+
+    template <class State>
+    static constexpr std::pair<std::string_view, std::size_t> named(std::string_view svf)
+    {
+        return {svf, Jtag::Fsm::index_of<State>()};
+    }
+
+    // SVF state name to the machine state index, the order of the machine states is up to ReachableFsm
+    static std::size_t stateIndex(std::string_view svf)
+    {
+        using namespace Jtag;
+        static constexpr std::array<std::pair<std::string_view, std::size_t>, Fsm::state_count> names = {
+            named<Reset>("RESET"), named<Idle>("IDLE"),
+            named<SelectDrScan>("DRSELECT"), named<CaptureDr>("DRCAPTURE"), named<ShiftDr>("DRSHIFT"),
+            named<Exit1Dr>("DREXIT1"), named<PauseDr>("DRPAUSE"), named<Exit2Dr>("DREXIT2"),
+            named<UpdateDr>("DRUPDATE"),
+            named<SelectIrScan>("IRSELECT"), named<CaptureIr>("IRCAPTURE"), named<ShiftIr>("IRSHIFT"),
+            named<Exit1Ir>("IREXIT1"), named<PauseIr>("IRPAUSE"), named<Exit2Ir>("IREXIT2"),
+            named<UpdateIr>("IRUPDATE"),
+        };
+        for (auto const& [text, index] : names) {
+            if (text == svf)
+                return index;
+        }
+        return npos;
+    }
+
+    // Integer or real (1.0E+03) non-negative count
+    static bool parseCount(std::string const& text, std::size_t &value)
+    {
+        char *end = nullptr;
+        auto const number = std::strtod(text.c_str(), &end);
+        if (end == text.c_str() || *end != '\0' || !(number >= 0))
+            return false;
+        value = std::size_t(number);
+        return true;
+    }
+
+    // MSB-first hex string into the LSB-first words, bits over `bits` are dropped
+    static bool decodeHex(std::string_view hex, std::size_t bits, std::vector<std::uint64_t> &out)
+    {
+        out.assign((bits + 63) / 64, 0);
+        static constexpr auto nibbles = [] {
+            std::array<std::uint8_t, 256> table{};
+            table.fill(0xff);
+            for (int i = 0; i < 10; ++i)
+                table['0' + i] = std::uint8_t(i);
+            for (int i = 0; i < 6; ++i)
+                table['A' + i] = table['a' + i] = std::uint8_t(10 + i);
+            return table;
+        }();
+
+        std::size_t pos = 0;
+        for (auto it = hex.rbegin(); it != hex.rend() && pos < bits; ++it, pos += 4) {
+            auto const nibble = nibbles[static_cast<unsigned char>(*it)];
+            if (nibble == 0xff)
+                return false;
+            out[pos / 64] |= std::uint64_t(nibble) << (pos % 64);
+        }
+        if (bits % 64)
+            out.back() &= (std::uint64_t(1) << (bits % 64)) - 1;
+        return true;
+    }
+
+    static void ones(std::vector<std::uint64_t> &out, std::size_t bits)
+    {
+        out.assign((bits + 63) / 64, ~std::uint64_t(0));
+        if (bits % 64)
+            out.back() = (std::uint64_t(1) << (bits % 64)) - 1;
+    }
+
+    bool scan(std::span<Token const> cmd, ScanParams &p, std::size_t shiftState, std::size_t endState)
+    {
+        if (cmd.size() < 2)
+            return fail(cmd[0].text + ": length expected");
+
+        std::size_t length;
+        if (!parseCount(cmd[1].text, length))
+            return fail(cmd[0].text + ": bad length");
+
+        if (length != p.length) {
+            // TDI/MASK/SMASK are sticky only for the same length
+            p.length = length;
+            p.tdi.assign((length + 63) / 64, 0);
+            ones(p.mask, length);
+            ones(p.smask, length);
+        }
+
+        bool checkTdo = false;
+        for (std::size_t i = 2; i + 1 < cmd.size(); i += 2) {
+            auto const& key = cmd[i].text;
+            auto const& value = cmd[i + 1];
+            if (!value.data)
+                return fail(cmd[0].text + ": data expected after " + key);
+
+            std::vector<std::uint64_t> *dst = nullptr;
+            if (key == "TDI")
+                dst = &p.tdi;
+            else if (key == "TDO") {
+                dst = &p.tdo;
+                checkTdo = true;
+            } else if (key == "MASK")
+                dst = &p.mask;
+            else if (key == "SMASK")
+                dst = &p.smask;
+            else
+                return fail(cmd[0].text + ": unknown parameter " + key);
+
+            if (!decodeHex(value.text, length, *dst))
+                return fail(cmd[0].text + ": bad hex data for " + key);
+        }
+
+        if (length == 0)
+            return true;
+
+        _stats.tck += Jtag::moveTo(_sm, shiftState);
+
+        p.captured.resize((length + 63) / 64);
+        if (!Jtag::shift(_sm, p.tdi, checkTdo ? std::span{p.captured} : std::span<std::uint64_t>{}, length))
+            return fail(cmd[0].text + ": shift failed");
+
+        _stats.tck += length;
+        _stats.shiftedBits += length;
+        _stats.tck += Jtag::moveTo(_sm, endState);
+
+        if (checkTdo) {
+            for (std::size_t i = 0; i < p.tdo.size(); ++i) {
+                if ((p.captured[i] ^ p.tdo[i]) & p.mask[i]) {
+                    ++_stats.tdoMismatches;
+                    break;
+                }
+            }
+        }
+
+        return true;
+    }
+
+    // RUNTEST [run_state] run_count TCK|SCK [min_time SEC] [MAXIMUM max_time SEC] [ENDSTATE end_state]
+    // RUNTEST [run_state] min_time SEC [MAXIMUM max_time SEC] [ENDSTATE end_state]
+    bool runTest(std::span<Token const> cmd)
+    {
+        std::size_t i = 1;
+        if (i < cmd.size() && stateIndex(cmd[i].text) != npos)
+            _runState = stateIndex(cmd[i++].text);
+
+        std::size_t clocks = 0;
+        if (i + 1 < cmd.size() && (cmd[i + 1].text == "TCK" || cmd[i + 1].text == "SCK")) {
+            if (!parseCount(cmd[i].text, clocks))
+                return fail("RUNTEST: bad clocks count");
+            i += 2;
+        }
+
+        std::size_t endState = _runState;
+        for (; i < cmd.size(); ++i) {
+            if (cmd[i].text == "ENDSTATE" && i + 1 < cmd.size()) {
+                endState = stateIndex(cmd[i + 1].text);
+                if (endState == npos)
+                    return fail("RUNTEST: bad end state");
+                break;
+            }
+        }
+
+        _stats.tck += Jtag::moveTo(_sm, _runState);
+
+        // Stable states loop on TMS=0, except Reset
+        Ev::Tms const tms{_runState == Jtag::Fsm::index_of<Jtag::Reset>()};
+        for (std::size_t n = 0; n < clocks; ++n)
+            _sm.processEvent(tms);
+        _stats.tck += clocks;
+
+        _stats.tck += Jtag::moveTo(_sm, endState);
+        return true;
+    }
+
+    bool fail(std::string message)
+    {
+        _error = std::move(message);
+        return false;
+    }
+
+private:
+    Jtag::Fsm  &_sm;
+    ScanParams  _ir;
+    ScanParams  _dr;
+    std::size_t _endIr = Jtag::Fsm::index_of<Jtag::Idle>();
+    std::size_t _endDr = Jtag::Fsm::index_of<Jtag::Idle>();
+    std::size_t _runState = Jtag::Fsm::index_of<Jtag::Idle>();
+    Stats       _stats;
+    std::string _error;
+};
+
+} // Svf
@@ -0,0 +1,104 @@
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+#include "jtag.hpp"
+#include "svf.hpp"
+
+// Synthetic SVF for the throughput benchmark: bulk DR scans with the wrapped hex data, comments, run-test cycles and
+// loopback checks against the 32-bit DR of the simulated device
+static int generate(char const *path, std::size_t megabytes)
+{
+    auto file = std::fopen(path, "wb");
+    if (!file) {
+        std::perror(path);
+        return 1;
+    }
+
+    std::fputs("! vfsm jtag sample: synthetic SVF\n"
+               "TRST OFF;\nENDIR IDLE;\nENDDR IDLE;\nHIR 0;\nHDR 0;\nTIR 0;\nTDR 0;\n"
+               "STATE RESET;\nSTATE IDLE;\n"
+               "SIR 8 TDI (02) TDO (00) MASK (00);\n", file);
+
+    constexpr std::size_t scanBits = 1 << 16;
+    std::string hex;
+    std::uint32_t seed = 1;
+    for (std::size_t i = 0; i < scanBits / 4; ++i) {
+        seed = seed * 1664525u + 1013904223u;
+        hex.push_back("0123456789ABCDEF"[seed >> 28]);
+        if (i % 64 == 63)
+            hex.push_back('\n');
+    }
+
+    std::size_t written = 0;
+    for (std::size_t n = 0; written < megabytes * 1024 * 1024; ++n) {
+        written += std::fprintf(file, "// block %zu\nSDR %zu TDI (\n%s);\nRUNTEST IDLE 100 TCK ENDSTATE IDLE;\n",
+                                n, scanBits, hex.c_str());
+        written += std::fprintf(file, "SDR 32 TDI (A5C3%04zX);\nsdr 32 tdi (00000000) tdo (A5C3%04zX) mask (FFFFFFFF);\n",
+                                n & 0xffff, n & 0xffff);
+    }
+
+    std::fputs("STATE RESET;\n", file);
+    std::fclose(file);
+    return 0;
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc == 4 && std::strcmp(argv[1], "--generate") == 0)
+        return generate(argv[2], std::stoul(argv[3]));
+
+    if (argc != 2) {
+        std::fprintf(stderr, "usage: %s <file.svf>\n       %s --generate <file.svf> <megabytes>\n", argv[0], argv[0]);
+        return 2;
+    }
+
+    auto file = std::fopen(argv[1], "rb");
+    if (!file) {
+        std::perror(argv[1]);
+        return 1;
+    }
+
+    Jtag::Fsm sm{Jtag::JtagContext{}, Jtag::Reset{}};
+    Svf::Player player{sm};
+    Svf::Parser parser;
+
+    std::size_t bytes = 0;
+    bool ok = true;
+    bool readFailed = false;
+
+    auto const start = std::chrono::steady_clock::now();
+    {
+        Svf::ChunkReader reader{file};
+        for (auto chunk = reader.next(); ok && !chunk.empty(); chunk = reader.next()) {
+            bytes += chunk.size();
+            ok = parser.feed(chunk, [&](auto cmd) { return player.execute(cmd); });
+        }
+        readFailed = ok && reader.failed();
+    }
+    auto const truncated = ok && !readFailed && !parser.finish();
+    auto const stop = std::chrono::steady_clock::now();
+    std::fclose(file);
+
+    auto const sec = std::chrono::duration<double>(stop - start).count();
+    auto const& stats = player.stats();
+    std::printf("%zu bytes, %zu commands, %zu TCK, %zu bits shifted, %zu TDO mismatches: %.3f s, %.1f MiB/s\n",
+                bytes, stats.commands, stats.tck, stats.shiftedBits, stats.tdoMismatches, sec,
+                double(bytes) / (1024.0 * 1024.0) / sec);
+
+    if (!ok) {
+        std::fprintf(stderr, "error: %s\n", player.error().c_str());
+        return 1;
+    }
+    if (readFailed) {
+        std::fprintf(stderr, "error: %s: read failed\n", argv[1]);
+        return 1;
+    }
+    if (truncated) {
+        std::fprintf(stderr, "error: command without ';' at the end of the input\n");
+        return 1;
+    }
+
+    return stats.tdoMismatches ? 1 : 0;
+}
@@ -0,0 +1,112 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <utility>
+
+#include "jtag.hpp"
+
+namespace Jtag {
+
+//
+// Minimal TMS sequence between two TAP states: `length` TCK clocks, TMS for the clock `i` is `(bits >> i) & 1`
+//
+struct TmsPath
+{
+    std::uint8_t bits = 0;
+    std::uint8_t length = 0;
+};
+
+namespace detail {
+
+// Next TAP state index for every (state, TMS) pair, evaluated over the JtagContext transition table
+constexpr auto tmsTransitions()
+{
+    std::array<std::array<std::size_t, 2>, Fsm::state_count> next{};
+
+    [&]<std::size_t... I>(std::index_sequence<I...>) {
+        ([&] {
+            using State = std::variant_alternative_t<I, Fsm::StateVariant>;
+            for (std::size_t tms = 0; tms < 2; ++tms) {
+                JtagContext ctx{};
+                auto target = vfsm::unpure(ctx()(State{}, Ev::Tms{tms != 0}));
+                next[I][tms] = std::visit([](auto s) { return Fsm::index_of<decltype(s)>(); }, target);
+            }
+        }(), ...);
+    }(std::make_index_sequence<Fsm::state_count>{});
+
+    return next;
+}
+
+// Breadth-first search from every state, TMS=0 edge is preferred on ties
+constexpr auto tmsShortestPaths()
+{
+    constexpr auto count = Fsm::state_count;
+    constexpr auto next = tmsTransitions();
+
+    std::array<std::array<TmsPath, count>, count> paths{};
+
+    for (std::size_t from = 0; from < count; ++from) {
+        std::array<bool, count> seen{};
+        std::array<std::size_t, count> queue{};
+        std::size_t head = 0, tail = 0;
+
+        seen[from] = true;
+        queue[tail++] = from;
+
+        while (head < tail) {
+            auto const state = queue[head++];
+            auto const path = paths[from][state];
+            for (std::size_t tms = 0; tms < 2; ++tms) {
+                auto const target = next[state][tms];
+                if (seen[target])
+                    continue;
+                if (path.length == 8)
+                    throw "TMS path does not fit into the packed bits";
+                seen[target] = true;
+                paths[from][target] = TmsPath{std::uint8_t(path.bits | tms << path.length), std::uint8_t(path.length + 1)};
+                queue[tail++] = target;
+            }
+        }
+
+        for (auto reached : seen) {
+            if (!reached)
+                throw "TAP state unreachable";
+        }
+    }
+
+    return paths;
+}
+
+} // detail
+
+// All-pairs table, indexed by Fsm state indexes: tmsPaths[from][to]
+inline constexpr auto tmsPaths = detail::tmsShortestPaths();
+
+constexpr TmsPath tmsPath(std::size_t from, std::size_t to)
+{
+    return tmsPaths[from][to];
+}
+
+template <class From, class To>
+constexpr TmsPath tmsPath()
+{
+    return tmsPaths[Fsm::index_of<From>()][Fsm::index_of<To>()];
+}
+
+// Clock the machine into the target state by the shortest TMS sequence, returns TCK count
+constexpr unsigned moveTo(Fsm &sm, std::size_t target)
+{
+    auto const path = tmsPath(sm.state_index(), target);
+    for (unsigned i = 0; i < path.length; ++i)
+        sm.processEvent(Ev::Tms{((path.bits >> i) & 1) != 0});
+    return path.length;
+}
+
+template <class To>
+constexpr unsigned moveTo(Fsm &sm)
+{
+    return moveTo(sm, Fsm::index_of<To>());
+}
+
+} // Jtag
@@ -0,0 +1,114 @@
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "vfsm/vfsm.hpp"
+
+namespace Ev {
+struct Bit { bool val{}; using Domain = vfsm::Domain<&Bit::val>; };
+}
+
+namespace Detector {
+
+// Generated naive detector of the bit pattern: one state per last `Width` received bits
+constexpr unsigned Width = 5;
+constexpr unsigned Size = 1u << Width;
+constexpr unsigned Pattern = 0b10110;
+
+template <unsigned History>
+struct Last {};
+
+template <unsigned H>
+constexpr auto step()
+{
+    using Zero = Last<(H << 1) % Size>;
+    using One  = Last<((H << 1) | 1) % Size>;
+    return vfsm::pure([](Last<H>, Ev::Bit ev) -> std::variant<Zero, One> { if (ev.val) return One{}; return Zero{}; });
+}
+
+struct Context
+{
+    constexpr auto operator()()
+    {
+        return [this]<std::size_t... H>(std::index_sequence<H...>) {
+            return vfsm::overload{
+                step<H>()...,
+                [this](Last<Pattern>, auto, vfsm::OnEnter) { ++matches; }
+            };
+        }(std::make_index_sequence<Size>{});
+    }
+
+    std::uint64_t matches = 0;
+};
+
+// Same table, the states with identical rows share them: only the newest 4 bits decide the targets
+struct MinimalContext : Context
+{
+    using Minimize = std::tuple<Ev::Bit>;
+};
+
+template <class Ctx, std::size_t... H>
+auto machine(std::index_sequence<H...>) -> vfsm::Fsm<Ctx, Last<H>...>;
+
+template <class Ctx>
+using Fsm = decltype(machine<Ctx>(std::make_index_sequence<Size>{}));
+
+} // Detector
+
+template <class Machine>
+static std::pair<std::uint64_t, std::size_t> run(char const *name, std::vector<bool> const& bits)
+{
+    Machine sm{{}, Detector::Last<0>{}};
+
+    auto const start = std::chrono::steady_clock::now();
+    for (bool bit : bits)
+        sm.processEvent(Ev::Bit{bit});
+    auto const stop = std::chrono::steady_clock::now();
+
+    auto const ns = std::chrono::duration<double, std::nano>(stop - start).count() / double(bits.size());
+    std::printf("%-10s: states %2zu, classes %2zu, dispatch rows %2zu, %.2f ns/event, matches %llu\n", name,
+                Machine::state_count, Machine::minimal_state_count(), Machine::dispatch_row_count(), ns,
+                static_cast<unsigned long long>(sm.context().matches));
+    return {sm.context().matches, sm.state_index()};
+}
+
+int main()
+{
+    using Full    = Detector::Fsm<Detector::Context>;
+    using Minimal = Detector::Fsm<Detector::MinimalContext>;
+
+    // Diagnostic: KMP automaton of the 5-bit pattern is 5 prefixes + full match
+    static_assert(Full::minimal_state_count() == 32);
+    static_assert(Minimal::minimal_state_count() == 6);
+    // Real targets are kept: histories differing in the oldest bit only share the row
+    static_assert(Minimal::dispatch_row_count() == 16);
+
+    std::vector<bool> bits(32 * 1024 * 1024);
+    std::mt19937_64 rng{7};
+    for (std::size_t i = 0; i < bits.size(); ++i)
+        bits[i] = (rng() & 1) != 0;
+
+    std::uint64_t expected = 0;
+    unsigned window = 0;
+    for (std::size_t i = 0; i < bits.size(); ++i) {
+        window = ((window << 1) | bits[i]) % Detector::Size;
+        expected += i + 1 >= Detector::Width && window == Detector::Pattern;
+    }
+
+    auto const full = run<Full>("full", bits);
+    auto const minimal = run<Minimal>("minimal", bits);
+    if (full.first != expected || minimal.first != expected) {
+        std::fprintf(stderr, "match count mismatch, expected %llu\n", static_cast<unsigned long long>(expected));
+        return 1;
+    }
+    // Both machines are in the state of the last received bits
+    if (full.second != window || minimal.second != window) {
+        std::fprintf(stderr, "state mismatch, expected Last<%u>\n", window);
+        return 1;
+    }
+
+    return 0;
+}
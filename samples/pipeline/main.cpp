@@ -0,0 +1,117 @@
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <random>
+#include <vector>
+
+#include "vfsm/pipeline.hpp"
+
+namespace Ev {
+struct Byte  { std::uint8_t val{}; using Domain = vfsm::Domain<&Byte::val, 0, 255>; };
+struct Frame {};
+}
+
+// Framing layer: STX payload... ETX
+namespace Framer {
+
+constexpr std::uint8_t Stx = 0x02;
+constexpr std::uint8_t Etx = 0x03;
+
+// States
+struct Idle    {};
+struct Payload {};
+struct End     {};
+
+struct Context
+{
+    constexpr auto operator()()
+    {
+        return vfsm::overload{
+            vfsm::pure([](Idle,    Ev::Byte ev) -> std::variant<Idle, Payload> { if (ev.val == Stx) return Payload{}; return Idle{}; }),
+            vfsm::pure([](Payload, Ev::Byte ev) -> std::variant<Payload, End>  { if (ev.val == Etx) return End{}; return Payload{}; }),
+            vfsm::pure([](End,     Ev::Byte ev) -> std::variant<Idle, Payload> { if (ev.val == Stx) return Payload{}; return Idle{}; }),
+            // Complete frame goes to the session layer
+            vfsm::pure([](End, vfsm::Output) { return Ev::Frame{}; })
+        };
+    }
+};
+
+using Fsm = vfsm::Fsm<Context, Idle, Payload, End>;
+
+} // Framer
+
+// Session layer: request/response frames after the hello frame
+namespace Session {
+
+// States
+struct Closed   {};
+struct Request  {};
+struct Response {};
+
+struct Context
+{
+    constexpr auto operator()()
+    {
+        return vfsm::overload{
+            vfsm::pure([](Closed,   Ev::Frame) { return Request{}; }),
+            vfsm::pure([](Request,  Ev::Frame) { return Response{}; }),
+            vfsm::pure([](Response, Ev::Frame) { return Request{}; }),
+
+            [this](Response, auto, vfsm::OnEnter) { ++responses; }
+        };
+    }
+
+    std::uint64_t responses = 0;
+};
+
+using Fsm = vfsm::Fsm<Context, Closed, Request, Response>;
+
+} // Session
+
+int main()
+{
+    // Random traffic with frequent frame delimiters
+    std::vector<std::uint8_t> input(64 * 1024 * 1024);
+    std::mt19937 rng{3};
+    for (auto &byte : input)
+        byte = std::uint8_t(rng() % 16);
+
+    // Two machines with the queue hop in between
+    Framer::Fsm framer{Framer::Context{}, Framer::Idle{}};
+    Session::Fsm session{Session::Context{}, Session::Closed{}};
+    std::deque<Ev::Frame> queue;
+
+    auto const t0 = std::chrono::steady_clock::now();
+    for (auto byte : input) {
+        framer.processEvent(Ev::Byte{byte});
+        if (framer.state_index() == Framer::Fsm::index_of<Framer::End>())
+            queue.push_back(Ev::Frame{});
+        while (!queue.empty()) {
+            session.processEvent(queue.front());
+            queue.pop_front();
+        }
+    }
+
+    // Same machines in the pipeline: outputs go straight to the downstream, no queue
+    auto const t1 = std::chrono::steady_clock::now();
+    vfsm::Pipeline stack{Framer::Fsm{Framer::Context{}, Framer::Idle{}}, Session::Fsm{Session::Context{}, Session::Closed{}}};
+    for (auto byte : input)
+        stack.processEvent(Ev::Byte{byte});
+    auto const t2 = std::chrono::steady_clock::now();
+
+    auto const ns = [&](auto dt) { return std::chrono::duration<double, std::nano>(dt).count() / double(input.size()); };
+    std::printf("chained : %.2f ns/byte, responses %llu\n", ns(t1 - t0),
+                static_cast<unsigned long long>(session.context().responses));
+    std::printf("pipeline: %.2f ns/byte, responses %llu\n", ns(t2 - t1),
+                static_cast<unsigned long long>(stack.downstream().context().responses));
+
+    if (session.context().responses != stack.downstream().context().responses ||
+        session.state_index() != stack.downstream().state_index() ||
+        framer.state_index() != stack.upstream().state_index()) {
+        std::fprintf(stderr, "pipeline diverged from the chained machines\n");
+        return 1;
+    }
+
+    return 0;
+}
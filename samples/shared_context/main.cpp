@@ -0,0 +1,125 @@
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+#include "vfsm/vfsm.hpp"
+
+namespace Ev {
+struct Packet  { std::uint8_t kind{}; };
+struct Timeout {};
+}
+
+namespace Proto {
+
+// States
+struct Idle {};
+struct Wait {};
+struct Fail {};
+
+// Configuration, identical for all sessions
+struct Config
+{
+    std::array<std::uint32_t, 64> timeouts{};
+    std::array<std::uint8_t, 256> accepted{};
+    std::uint16_t maxRetries = 3;
+};
+
+// Per-session mutable data
+struct Session
+{
+    std::uint16_t retries = 0;
+    std::uint32_t received = 0;
+};
+
+//
+// Classic way: whole configuration copied into every machine
+//
+struct FullContext
+{
+    constexpr auto operator()()
+    {
+        return vfsm::overload {
+            [this](Idle, Ev::Packet ev) -> std::variant<Idle, Wait> { if (!cfg.accepted[ev.kind]) return {}; ++s.received; return Wait{}; },
+            [this](Wait, Ev::Packet ev) -> std::variant<Idle, Wait> { if (!cfg.accepted[ev.kind]) return Wait{}; ++s.received; return {}; },
+            [this](Wait, Ev::Timeout)   -> std::variant<Wait, Fail> { if (++s.retries == cfg.maxRetries) return Fail{}; return {}; },
+            [this](Fail, Ev::Packet)    -> Idle { s = {}; return {}; }
+        };
+    }
+
+    Config  cfg{};
+    Session s{};
+};
+
+//
+// Flyweight: configuration is referenced, only Session is stored per machine
+//
+struct SharedTable
+{
+    constexpr auto operator()(Session &s) const
+    {
+        return vfsm::overload {
+            [this,&s](Idle, Ev::Packet ev) -> std::variant<Idle, Wait> { if (!cfg.accepted[ev.kind]) return {}; ++s.received; return Wait{}; },
+            [this,&s](Wait, Ev::Packet ev) -> std::variant<Idle, Wait> { if (!cfg.accepted[ev.kind]) return Wait{}; ++s.received; return {}; },
+            [this,&s](Wait, Ev::Timeout)   -> std::variant<Wait, Fail> { if (++s.retries == cfg.maxRetries) return Fail{}; return {}; },
+            [   &s  ](Fail, Ev::Packet)    -> Idle { s = {}; return {}; }
+        };
+    }
+
+    Config cfg{};
+};
+
+using FullFsm   = vfsm::Fsm<FullContext, Idle, Wait, Fail>;
+using SharedFsm = vfsm::Fsm<vfsm::SharedContext<SharedTable, Session>, Idle, Wait, Fail>;
+
+}
+
+template <class Machines>
+static double run(Machines &machines, std::size_t &checksum)
+{
+    auto const start = std::chrono::steady_clock::now();
+    for (unsigned round = 0; round < 8; ++round) {
+        std::uint8_t kind = 0;
+        for (auto &sm : machines) {
+            sm.processEvent(Ev::Packet{kind++});
+            if (kind % 3 == 0)
+                sm.processEvent(Ev::Timeout{});
+            checksum += sm.state_index();
+        }
+    }
+    auto const stop = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(stop - start).count();
+}
+
+int main()
+{
+    constexpr std::size_t count = 1'000'000;
+
+    Proto::Config cfg{};
+    for (std::size_t i = 0; i < cfg.accepted.size(); i += 2)
+        cfg.accepted[i] = 1;
+
+    static Proto::SharedTable const table{cfg};
+
+    std::vector<Proto::FullFsm> full;
+    std::vector<Proto::SharedFsm> shared;
+    full.reserve(count);
+    shared.reserve(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        full.emplace_back(Proto::FullContext{cfg, {}}, Proto::Idle{});
+        shared.emplace_back(vfsm::SharedContext<Proto::SharedTable, Proto::Session>{table}, Proto::Idle{});
+    }
+
+    std::size_t fullSum = 0, sharedSum = 0;
+    auto const fullMs   = run(full, fullSum);
+    auto const sharedMs = run(shared, sharedSum);
+
+    std::printf("instances: %zu\n", count);
+    std::printf("full context  : %4zu bytes/instance, %7.1f MiB total, %7.1f ms, checksum %zu\n",
+                sizeof(Proto::FullFsm), double(sizeof(Proto::FullFsm) * count) / (1024.0 * 1024.0), fullMs, fullSum);
+    std::printf("shared context: %4zu bytes/instance, %7.1f MiB total, %7.1f ms, checksum %zu\n",
+                sizeof(Proto::SharedFsm), double(sizeof(Proto::SharedFsm) * count) / (1024.0 * 1024.0), sharedMs, sharedSum);
+
+    return fullSum == sharedSum ? 0 : 1;
+}
@@ -0,0 +1,100 @@
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "vfsm/trace.hpp"
+
+namespace Ev {
+struct Connect {};
+struct Ack     {};
+struct Refuse  {};
+struct Close   {};
+}
+
+// States
+struct Idle        {};
+struct Handshake   {};
+struct Established {};
+struct Refused     {};
+
+struct Session : vfsm::TracingContext<vfsm::ChromeTrace, Ev::Connect, Ev::Ack, Ev::Refuse, Ev::Close>
+{
+    using TracingContext::TracingContext;
+
+    auto operator()()
+    {
+        return vfsm::overload{
+            [](Idle,        Ev::Connect) { return Handshake{}; },
+            [](Handshake,   Ev::Ack)     { return Established{}; },
+            [](Handshake,   Ev::Refuse)  { return Refused{}; },
+            [](Handshake,   Ev::Close)   { return Idle{}; },
+            [](Established, Ev::Close)   { return Idle{}; },
+            [](Refused,     Ev::Close)   { return Idle{}; }
+        };
+    }
+};
+
+using Fsm = vfsm::Fsm<Session, Idle, Handshake, Established, Refused>;
+
+// "Ev::Connect", ...
+constexpr auto& eventNames = vfsm::type_names<Ev::Connect, Ev::Ack, Ev::Refuse, Ev::Close>;
+
+// Some work between the events to make the timeline readable
+static void work(unsigned us)
+{
+    auto const until = std::chrono::steady_clock::now() + std::chrono::microseconds{us};
+    while (std::chrono::steady_clock::now() < until)
+        ;
+}
+
+// Random traffic over 8 sessions, returns count of the records
+static std::size_t simulate(std::filesystem::path const& path, vfsm::TraceSampler *sampler)
+{
+    std::ofstream file{path};
+    vfsm::ChromeTrace trace{file, Fsm::state_names, eventNames};
+
+    std::vector<Fsm> pool;
+    for (std::uint32_t i = 0; i < 8; ++i) {
+        pool.emplace_back(sampler ? Session{trace, i, *sampler} : Session{trace, i}, Idle{});
+        trace.nameTrack(i, "session " + std::to_string(i));
+    }
+
+    std::mt19937 rng{5};
+    for (int i = 0; i < 100'000; ++i) {
+        auto &sm = pool[rng() % pool.size()];
+        switch (rng() % 3) {
+            case 0: sm.processEvent(Ev::Connect{}); break;
+            case 1: rng() % 100 ? sm.processEvent(Ev::Ack{}) : sm.processEvent(Ev::Refuse{}); break;
+            default: sm.processEvent(Ev::Close{}); break;
+        }
+        work(rng() % 8);
+    }
+    // Spans of the current states are still open
+    for (auto &sm : pool)
+        sm.context().flush();
+    return trace.size();
+}
+
+int main(int argc, char **argv)
+{
+    auto const dir = argc > 1 ? std::filesystem::path{argv[1]} : std::filesystem::temp_directory_path();
+
+    auto const full = dir / "vfsm_trace.json";
+    auto const records = simulate(full, nullptr);
+    std::uintmax_t const bytes = std::filesystem::file_size(full);
+    std::printf("%zu records, %ju bytes written to %s\n", records, bytes, full.c_str());
+
+    // One of 64 events, all the refused handshakes
+    vfsm::TraceSampler sampler{64, {Fsm::index_of<Refused>()}};
+    auto const sampled = dir / "vfsm_trace_sampled.json";
+    auto const sampledRecords = simulate(sampled, &sampler);
+    std::uintmax_t const sampledBytes = std::filesystem::file_size(sampled);
+    std::printf("%zu records, %ju bytes written to %s\n", sampledRecords, sampledBytes, sampled.c_str());
+
+    std::printf("open them in chrome://tracing or https://ui.perfetto.dev\n");
+}
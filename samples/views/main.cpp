@@ -0,0 +1,111 @@
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <ranges>
+#include <span>
+#include <vector>
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "vfsm/views.hpp"
+
+namespace Ev {
+struct Byte { std::uint8_t val{}; using Domain = vfsm::Domain<&Byte::val, 0, 255>; };
+}
+
+// Framing layer of the captured trace: STX payload... ETX
+namespace Framer {
+
+constexpr std::uint8_t Stx = 0x02;
+constexpr std::uint8_t Etx = 0x03;
+
+// States
+struct Idle    {};
+struct Payload {};
+struct End     {};
+
+struct Context
+{
+    constexpr auto operator()()
+    {
+        return vfsm::overload{
+            vfsm::pure([](Idle,    Ev::Byte ev) -> std::variant<Idle, Payload> { if (ev.val == Stx) return Payload{}; return Idle{}; }),
+            vfsm::pure([](Payload, Ev::Byte ev) -> std::variant<Payload, End>  { if (ev.val == Etx) return End{}; return Payload{}; }),
+            vfsm::pure([](End,     Ev::Byte ev) -> std::variant<Idle, Payload> { if (ev.val == Stx) return Payload{}; return Idle{}; }),
+        };
+    }
+};
+
+using Fsm = vfsm::Fsm<Context, Idle, Payload, End>;
+
+// Payload length limit check needs the context: stateful machine
+struct Limited
+{
+    constexpr auto operator()()
+    {
+        return vfsm::overload{
+            [this](Idle,    Ev::Byte ev) -> std::variant<Idle, Payload> { length = 0; if (ev.val == Stx) return Payload{}; return Idle{}; },
+            [this](Payload, Ev::Byte ev) -> std::variant<Payload, End, Idle> { if (ev.val == Etx) return End{}; if (++length > limit) return Idle{}; return Payload{}; },
+            [this](End,     Ev::Byte ev) -> std::variant<Idle, Payload> { length = 0; if (ev.val == Stx) return Payload{}; return Idle{}; },
+        };
+    }
+
+    std::size_t length = 0;
+    std::size_t limit = 8;
+};
+
+using LimitedFsm = vfsm::Fsm<Limited, Idle, Payload, End>;
+
+} // Framer
+
+int main()
+{
+    constexpr std::size_t size = 64 * 1024 * 1024;
+
+    // Captured trace in the file, mapped into memory
+    auto file = std::tmpfile();
+    if (!file || ftruncate(fileno(file), size) != 0) {
+        std::perror("trace file");
+        return 1;
+    }
+    auto map = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fileno(file), 0);
+    if (map == MAP_FAILED) {
+        std::perror("mmap");
+        return 1;
+    }
+    std::span trace{static_cast<std::uint8_t*>(map), size};
+
+    std::mt19937 rng{5};
+    std::ranges::generate(trace, [&] { return std::uint8_t(rng() % 16); });
+
+    auto const events = trace | std::views::transform([](std::uint8_t b) { return Ev::Byte{b}; });
+
+    // Pure machine: no instance, states only
+    auto const frames = std::ranges::count(
+        events | vfsm::views::scan_states<Framer::Context, Framer::Idle, Framer::Payload, Framer::End>(Framer::Idle{}),
+        Framer::Fsm::index_of<Framer::End>());
+
+    // Stateful machine: stepped in place, composed with the standard views
+    Framer::LimitedFsm sm{Framer::Limited{}, Framer::Idle{}};
+    auto complete = events
+                  | vfsm::views::run(sm)
+                  | std::views::filter([](auto const& step) { return step.state == Framer::LimitedFsm::index_of<Framer::End>(); });
+    auto const short_frames = std::ranges::distance(complete);
+
+    // Cross-check with the plain loop
+    Framer::Fsm check{Framer::Context{}, Framer::Idle{}};
+    std::ptrdiff_t expected = 0;
+    for (auto byte : trace) {
+        check.processEvent(Ev::Byte{byte});
+        expected += check.state_index() == Framer::Fsm::index_of<Framer::End>();
+    }
+
+    std::printf("trace %zu bytes: frames %td, frames up to %zu bytes %td\n", size, frames, sm.context().limit, short_frames);
+
+    munmap(map, size);
+    std::fclose(file);
+
+    return frames == expected && short_frames <= frames ? 0 : 1;
+}
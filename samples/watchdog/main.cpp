@@ -0,0 +1,103 @@
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "vfsm/residency.hpp"
+
+using namespace std::chrono_literals;
+
+// Simulated time: the sample runs an hour of traffic in a moment
+struct SimClock
+{
+    using rep = std::int64_t;
+    using period = std::milli;
+    using duration = std::chrono::duration<rep, period>;
+    using time_point = std::chrono::time_point<SimClock>;
+    static constexpr bool is_steady = true;
+
+    static time_point now() noexcept
+    {
+        return time_point{duration{ticks}};
+    }
+
+    static inline rep ticks = 0;
+};
+
+namespace Ev {
+struct Connect {};
+struct Ack     {};
+struct Close   {};
+}
+
+// States
+struct Idle        {};
+struct Handshake   {};
+struct Established {};
+
+struct Session : vfsm::Residency<3, SimClock>
+{
+    auto operator()()
+    {
+        return vfsm::overload{
+            [](Idle,        Ev::Connect) { return Handshake{}; },
+            [](Handshake,   Ev::Ack)     { return Established{}; },
+            [](Handshake,   Ev::Close)   { return Idle{}; },
+            [](Established, Ev::Close)   { return Idle{}; }
+        };
+    }
+};
+
+using Fsm = vfsm::Fsm<Session, Idle, Handshake, Established>;
+
+int main()
+{
+    constexpr std::size_t sessions = 100'000;
+
+    vfsm::Watchdog<3, SimClock> watchdog{{vfsm::Watchdog<3, SimClock>::unlimited, 10min, 1h}};
+
+    std::vector<Fsm> pool;
+    pool.reserve(sessions);
+    for (std::size_t i = 0; i < sessions; ++i) {
+        pool.emplace_back(Session{}, Idle{});
+        pool.back().context().watch(watchdog, watchdog.add());
+    }
+
+    // Every second a few sessions move, every 1000th peer never acks the handshake
+    std::mt19937 rng{7};
+    std::size_t stuck = 0;
+    std::chrono::nanoseconds scanTime{};
+    for (int second = 0; second < 3600; ++second) {
+        SimClock::ticks += 1000;
+        for (int i = 0; i < 1000; ++i) {
+            auto const slot = rng() % sessions;
+            auto &sm = pool[slot];
+            if (sm.state_index() == Fsm::index_of<Idle>())
+                sm.processEvent(Ev::Connect{});
+            else if (sm.state_index() == Fsm::index_of<Established>())
+                sm.processEvent(Ev::Close{});
+            else if (slot % 1000 != 0)
+                sm.processEvent(Ev::Ack{});
+        }
+
+        auto const start = std::chrono::steady_clock::now();
+        stuck += watchdog.scan(SimClock::now(), [&](std::size_t slot) {
+            // Drop the session, the watchdog slot is re-armed by the state change
+            pool[slot].processEvent(Ev::Close{});
+        });
+        scanTime += std::chrono::steady_clock::now() - start;
+    }
+
+    // Residency totals over the pool
+    std::chrono::duration<double> handshake{}, established{};
+    for (auto &sm : pool) {
+        handshake += sm.context().residency(Fsm::index_of<Handshake>());
+        established += sm.context().residency(Fsm::index_of<Established>());
+    }
+
+    std::printf("stuck sessions dropped: %zu\n", stuck);
+    std::printf("time in Handshake: %.0f s, in Established: %.0f s\n", handshake.count(), established.count());
+    std::printf("scan of %zu sessions: %.1f us\n", sessions,
+                std::chrono::duration<double, std::micro>(scanTime).count() / 3600);
+}
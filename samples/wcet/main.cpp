@@ -0,0 +1,54 @@
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <iostream>
+#include <thread>
+
+#include "vfsm/wcet.hpp"
+
+#include "../debug_dispatch/motor.hpp"
+
+using namespace std::chrono_literals;
+
+// Counter ticks per nanosecond, by the steady clock
+static double tickRate()
+{
+    auto const start = std::chrono::steady_clock::now();
+    auto const ticks = vfsm::CycleCounter::now();
+    std::this_thread::sleep_for(50ms);
+    auto const elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start);
+    return double(vfsm::CycleCounter::now() - ticks) / elapsed.count();
+}
+
+int main()
+{
+    // Every event the 10 kHz control loop may deliver: speeds below, at and over the limit
+    vfsm::Wcet<Motor::Fsm> wcet{10'000, 200};
+    wcet.run([](Motor::Fsm::StateVariant &&state) { return Motor::Fsm{Motor::Controller{}, std::move(state)}; },
+             Ev::Command{1500}, Ev::Tick{0}, Ev::Tick{2000}, Ev::Tick{5000}, Ev::Stop{});
+    wcet.report(std::cout, Motor::Fsm::state_names);
+
+    // Budget of the event within the loop period: the observed maximum must fit, never a filtered value
+    constexpr auto period = std::chrono::duration<double, std::nano>(100us);
+    auto const rate = tickRate();
+    bool fits = true;
+    for (bool cold : {false, true}) {
+        auto const &worst = *wcet.worst(cold);
+        auto const &stats = cold ? worst.cold : worst.warm;
+        auto const state = Motor::Fsm::state_names[worst.state];
+        auto const share = double(stats.max) / rate / period.count();
+        std::printf("worst %s: %.*s + %.*s #%zu, max %llu ticks, %.0f ns, %.3f%% of the 10 kHz period "
+                    "(p99.9 %llu ticks, %zu outliers)\n",
+                    cold ? "cold" : "warm", int(state.size()), state.data(),
+                    int(worst.eventName.size()), worst.eventName.data(), worst.event,
+                    static_cast<unsigned long long>(stats.max), double(stats.max) / rate, 100.0 * share,
+                    static_cast<unsigned long long>(stats.p999), stats.outliers);
+        fits = fits && share <= 1.0;
+    }
+
+    if (!fits) {
+        std::fprintf(stderr, "observed maximum exceeds the control loop period\n");
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,82 @@
+// OnExit/OnEnter and onStateChange call order, same in the default and the VFSM_SMALL_FOOTPRINT modes
+
+#include <cstdio>
+#include <string>
+
+#include "vfsm/vfsm.hpp"
+
+namespace Ev {
+struct Go    {};
+struct Hold  {};
+struct Halt  {};
+struct Reset {};
+}
+
+struct Idle  {};
+struct Run   {};
+struct Pause {};
+struct Stop  {};
+
+struct Table
+{
+    auto operator()()
+    {
+        return vfsm::overload{
+            [](Idle, Ev::Go) -> Run { return {}; },
+            [](Run, Ev::Go) -> Run { return {}; },
+            [](Run, Ev::Hold) -> Pause { return {}; },
+            [](Pause, Ev::Go) -> Run { return {}; },
+            [](Pause, Ev::Halt) -> Stop { return {}; },
+            [](auto, Ev::Reset) -> Idle { return {}; },
+
+            // Short forms
+            [this](Idle, vfsm::OnExit) { log += "exit Idle;"; },
+            [this](Idle, vfsm::OnEnter) { log += "enter Idle;"; },
+            [this](Run, vfsm::OnEnter) { log += "enter Run;"; },
+            [this](Pause, vfsm::OnEnter) { log += "enter Pause;"; },
+            [this](Pause, vfsm::OnExit) { log += "exit Pause;"; },
+            [this](Stop, vfsm::OnEnter) { log += "enter Stop;"; },
+            // Paired forms take precedence for their pairs
+            [this](Run, Idle, vfsm::OnEnter) { log += "enter Run from Idle;"; },
+            [this](Pause, Run, vfsm::OnExit) { log += "exit Pause to Run;"; }
+        };
+    }
+
+    void onStateChange(std::size_t from, std::size_t to)
+    {
+        log += "change " + std::to_string(from) + "->" + std::to_string(to) + ";";
+    }
+
+    std::string log;
+};
+
+using Fsm = vfsm::Fsm<Table, Idle, Run, Pause, Stop>;
+
+int main()
+{
+    Fsm sm{Table{}, Idle{}};
+    sm.processEvent(Ev::Go{});    // paired OnEnter
+    sm.processEvent(Ev::Go{});    // self-transition, no hooks
+    sm.processEvent(Ev::Hold{});
+    sm.processEvent(Ev::Go{});    // paired OnExit
+    sm.processEvent(Ev::Hold{});
+    sm.processEvent(Ev::Halt{});  // short forms only
+    sm.processEvent(Ev::Reset{});
+
+    std::string const expected =
+        "enter Idle;"
+        "exit Idle;change 0->1;enter Run from Idle;"
+        "change 1->2;enter Pause;"
+        "exit Pause to Run;change 2->1;enter Run;"
+        "change 1->2;enter Pause;"
+        "exit Pause;change 2->3;enter Stop;"
+        "change 3->0;enter Idle;";
+
+    auto const& log = sm.context().log;
+    if (log != expected) {
+        std::printf("VFSM_SMALL_FOOTPRINT=%d\n  got:      %s\n  expected: %s\n", VFSM_SMALL_FOOTPRINT, log.c_str(),
+                    expected.c_str());
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,88 @@
+// Pure transitions keep the state values returned by the handlers
+
+#include <cstdio>
+#include <variant>
+
+#include "vfsm/vfsm.hpp"
+
+namespace Ev {
+struct Bit { bool val{}; using Domain = vfsm::Domain<&Bit::val>; };
+}
+
+struct A { int v = 0; };
+struct B { int v = 0; };
+
+struct Empty  {};
+struct Other  {};
+
+template <bool Pure>
+struct Table
+{
+    constexpr auto operator()()
+    {
+        auto handler = [](auto fn) {
+            if constexpr (Pure)
+                return vfsm::pure(fn);
+            else
+                return fn;
+        };
+        return vfsm::overload{
+            handler([](A, Ev::Bit ev) -> std::variant<A, B> { if (ev.val) return B{42}; return A{7}; }),
+            handler([](B, Ev::Bit) -> A { return A{9}; }),
+        };
+    }
+};
+
+struct EmptyTable
+{
+    constexpr auto operator()()
+    {
+        return vfsm::overload{
+            vfsm::pure([](Empty, Ev::Bit ev) -> std::variant<Empty, Other> { if (ev.val) return Other{}; return {}; }),
+            vfsm::pure([](Other, Ev::Bit) -> Empty { return {}; }),
+        };
+    }
+};
+
+template <bool Pure>
+using Fsm = vfsm::Fsm<Table<Pure>, A, B>;
+
+// Values seen after the self-transition, A -> B and B -> A
+template <bool Pure>
+constexpr int trace()
+{
+    Fsm<Pure> sm{Table<Pure>{}, A{}};
+    int result = 0;
+    sm.processEvent(Ev::Bit{false});
+    result = result * 100 + sm.visit([](auto s) { return s.v; });
+    sm.processEvent(Ev::Bit{true});
+    result = result * 100 + sm.visit([](auto s) { return s.v; });
+    sm.processEvent(Ev::Bit{false});
+    result = result * 100 + sm.visit([](auto s) { return s.v; });
+    return result;
+}
+
+static_assert(trace<false>() == 74209);
+static_assert(trace<true>() == 74209);
+
+// Table is used only for the empty states
+static_assert(!Fsm<true>::is_pure<Ev::Bit>());
+static_assert(vfsm::Fsm<EmptyTable, Empty, Other>::is_pure<Ev::Bit>());
+
+int main()
+{
+    auto const plain = trace<false>();
+    auto const pure = trace<true>();
+    if (plain != 74209 || pure != 74209) {
+        std::printf("state values after transitions: plain %d, pure %d, expected 74209\n", plain, pure);
+        return 1;
+    }
+
+    vfsm::Fsm<EmptyTable, Empty, Other> sm{EmptyTable{}, Empty{}};
+    sm.processEvent(Ev::Bit{true});
+    if (sm.state_index() != 1) {
+        std::printf("precomputed transition failed\n");
+        return 1;
+    }
+    return 0;
+}
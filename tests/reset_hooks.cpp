@@ -0,0 +1,73 @@
+// reset_all() of the trivially copyable pool fires the initial OnEnter and onStart() like reset() does
+
+#include <array>
+#include <cstdio>
+
+#include "vfsm/vfsm.hpp"
+
+struct Ev {};
+
+struct Idle {};
+struct Run  {};
+
+// No OnEnter: only the onStart() hook marks the start
+struct Plain
+{
+    constexpr auto operator()()
+    {
+        return vfsm::overload{
+            [](Idle, Ev) -> Run { return {}; }
+        };
+    }
+
+    void onStart(std::size_t state)
+    {
+        ++starts;
+        started = state;
+    }
+
+    int         starts = 0;
+    std::size_t started = 99;
+    int         enters = 0;
+};
+
+struct WithEnter : Plain
+{
+    constexpr auto operator()()
+    {
+        return vfsm::overload{
+            [](Idle, Ev) -> Run { return {}; },
+            [this](Run, vfsm::OnEnter) { ++enters; }
+        };
+    }
+};
+
+template <class Context>
+static bool check(char const *name)
+{
+    using Fsm = vfsm::Fsm<Context, Idle, Run>;
+    static_assert(std::is_trivially_copyable_v<Fsm>, "reset_all() must take the raw fill path");
+
+    std::array<Fsm, 5> pool{
+        Fsm{Context{}, Idle{}}, Fsm{Context{}, Idle{}}, Fsm{Context{}, Idle{}}, Fsm{Context{}, Idle{}},
+        Fsm{Context{}, Idle{}}};
+    Fsm::reset_all(pool, Run{});
+
+    Fsm single{Context{}, Idle{}};
+    single.reset(Run{});
+
+    bool ok = true;
+    for (auto const& sm : pool) {
+        ok = ok && sm.context().starts == single.context().starts && sm.context().started == single.context().started &&
+             sm.context().enters == single.context().enters && sm.state_index() == single.state_index();
+    }
+    ok = ok && single.context().starts == 1 && single.context().started == Fsm::template index_of<Run>();
+    if (!ok)
+        std::printf("%s: reset_all() hooks differ from reset()\n", name);
+    return ok;
+}
+
+int main()
+{
+    return check<Plain>("plain") && check<WithEnter>("with OnEnter") ? 0 : 1;
+}
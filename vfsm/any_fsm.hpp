@@ -0,0 +1,186 @@
+//
+// Distributed under MIT license.
+//
+// Copyright 2024 Alexander Drozdov <adrozdoff@gmail.com>
+// Author: Alexander Drozdov <adrozdoff@gmail.com>
+// Site:   https://github.com/h4tr3d/fsm_variant/
+//
+
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <new>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "vfsm.hpp"
+
+namespace vfsm {
+
+/**
+ * Allocation-free type-erased handle over any vfsm::Fsm
+ *
+ * Machine stored in-place inside the handle in the buffer of `Size` bytes, so a heterogeneous registry can be kept in
+ * the plain `std::vector<AnyFsm<...>>` without per-machine and per-call heap allocations. Every operation costs
+ * exactly one indirect call through the static per-machine-type operations table.
+ *
+ * Only events declared in the `Events...` list can be passed to the `processEvent()`.
+ *
+ * Sample:
+ * ```
+ * using AnyMachine = vfsm::AnyFsm<64, EvToggle, EvReset>;
+ *
+ * std::vector<AnyMachine> machines;
+ * machines.emplace_back(LampSwitchFsm{FsmContext{}, Off{}});
+ * machines.emplace_back(std::in_place_type<CounterFsm>, CounterContext{}, Idle{});
+ *
+ * for (auto& sm : machines)
+ *     sm.processEvent(EvToggle{});
+ * ```
+ */
+template <std::size_t Size, class... Events>
+class AnyFsm
+{
+    struct Ops
+    {
+        void        (*destroy)(void *self) noexcept;
+        void        (*relocate)(void *dst, void *src) noexcept;
+        bool        (*poll)(void *self);
+        std::size_t (*state_index)(void const *self) noexcept;
+        std::tuple<bool (*)(void *self, Events &&event)...> process;
+    };
+
+    template <class Machine>
+    static constexpr Ops s_ops = {
+        [](void *self) noexcept {
+            static_cast<Machine*>(self)->~Machine();
+        },
+        [](void *dst, void *src) noexcept {
+            ::new (dst) Machine(std::move(*static_cast<Machine*>(src)));
+            static_cast<Machine*>(src)->~Machine();
+        },
+        [](void *self) -> bool {
+            return static_cast<Machine*>(self)->poll();
+        },
+        [](void const *self) noexcept -> std::size_t {
+            return static_cast<Machine const*>(self)->state_index();
+        },
+        {
+            [](void *self, Events &&event) -> bool {
+                return static_cast<Machine*>(self)->processEvent(std::move(event));
+            }...
+        }
+    };
+
+    template <class Machine>
+    static constexpr bool fits = sizeof(Machine) <= Size &&
+                                 alignof(std::max_align_t) % alignof(Machine) == 0 &&
+                                 std::is_nothrow_move_constructible_v<Machine>;
+
+public:
+    AnyFsm() noexcept = default;
+
+    template <class Machine>
+        requires (!std::is_same_v<std::remove_cvref_t<Machine>, AnyFsm>)
+    AnyFsm(Machine &&sm)
+    {
+        emplace<std::remove_cvref_t<Machine>>(std::forward<Machine>(sm));
+    }
+
+    template <class Machine, class... Args>
+    explicit AnyFsm(std::in_place_type_t<Machine>, Args&&... args)
+    {
+        emplace<Machine>(std::forward<Args>(args)...);
+    }
+
+    AnyFsm(AnyFsm &&other) noexcept
+    {
+        if (other._ops) {
+            other._ops->relocate(_storage, other._storage);
+            _ops = std::exchange(other._ops, nullptr);
+        }
+    }
+
+    AnyFsm& operator=(AnyFsm &&other) noexcept
+    {
+        if (this != &other) {
+            reset();
+            if (other._ops) {
+                other._ops->relocate(_storage, other._storage);
+                _ops = std::exchange(other._ops, nullptr);
+            }
+        }
+        return *this;
+    }
+
+    AnyFsm(AnyFsm const&) = delete;
+    AnyFsm& operator=(AnyFsm const&) = delete;
+
+    ~AnyFsm()
+    {
+        reset();
+    }
+
+    /**
+     * Construct machine in-place, previous one is destroyed
+     */
+    template <class Machine, class... Args>
+    Machine& emplace(Args&&... args)
+    {
+        static_assert(fits<Machine>, "Machine does not fit AnyFsm storage or has throwing move constructor");
+        reset();
+        auto sm = ::new (static_cast<void*>(_storage)) Machine(std::forward<Args>(args)...);
+        _ops = &s_ops<Machine>;
+        return *sm;
+    }
+
+    void reset() noexcept
+    {
+        if (_ops) {
+            std::exchange(_ops, nullptr)->destroy(_storage);
+        }
+    }
+
+    explicit operator bool() const noexcept
+    {
+        return _ops != nullptr;
+    }
+
+    //
+    // Machine access: the handle must not be empty (see operator bool), e.g. moved-from or reset
+    //
+    bool poll()
+    {
+        assert(_ops && "empty AnyFsm");
+        return _ops->poll(_storage);
+    }
+
+    template <typename Event>
+        requires (std::is_same_v<std::remove_cvref_t<Event>, Events> || ...)
+    bool processEvent(Event &&event)
+    {
+        assert(_ops && "empty AnyFsm");
+        using EventType = std::remove_cvref_t<Event>;
+        auto fn = std::get<bool (*)(void*, EventType&&)>(_ops->process);
+        if constexpr (std::is_lvalue_reference_v<Event>) {
+            EventType copy = event;
+            return fn(_storage, std::move(copy));
+        } else {
+            return fn(_storage, std::move(event));
+        }
+    }
+
+    std::size_t state_index() const noexcept
+    {
+        assert(_ops && "empty AnyFsm");
+        return _ops->state_index(_storage);
+    }
+
+private:
+    Ops const *_ops = nullptr;
+    alignas(std::max_align_t) std::byte _storage[Size];
+};
+
+} // vfsm
@@ -0,0 +1,445 @@
+//
+// Distributed under MIT license.
+//
+// Copyright 2024 Alexander Drozdov <adrozdoff@gmail.com>
+// Author: Alexander Drozdov <adrozdoff@gmail.com>
+// Site:   https://github.com/h4tr3d/fsm_variant/
+//
+
+#pragma once
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <stop_token>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#include "vfsm.hpp"
+
+namespace vfsm {
+
+namespace detail {
+
+/**
+ * Move-only `void(Args...)` callable: the single allocation per job, the call is the virtual one
+ */
+template <class Signature>
+class UniqueFunction;
+
+template <class... Args>
+class UniqueFunction<void(Args...)>
+{
+public:
+    UniqueFunction() = default;
+
+    template <class Fn>
+        requires (!std::is_same_v<std::remove_cvref_t<Fn>, UniqueFunction> && std::is_invocable_v<Fn&, Args...>)
+    UniqueFunction(Fn &&fn)
+        : _callable{std::make_unique<Callable<std::decay_t<Fn>>>(std::forward<Fn>(fn))}
+    {}
+
+    /// `Fn` constructed in place, `target` refers to it while the function is alive
+    template <class Fn, class Arg>
+    static UniqueFunction make(Fn *&target, Arg &&arg)
+    {
+        auto callable = std::make_unique<Callable<Fn>>(std::forward<Arg>(arg));
+        target = &callable->fn;
+        UniqueFunction result;
+        result._callable = std::move(callable);
+        return result;
+    }
+
+    void operator()(Args... args)
+    {
+        _callable->call(std::forward<Args>(args)...);
+    }
+
+    explicit operator bool() const noexcept
+    {
+        return _callable != nullptr;
+    }
+
+private:
+    struct Base
+    {
+        virtual ~Base() = default;
+        virtual void call(Args... args) = 0;
+    };
+
+    template <class Fn>
+    struct Callable final : Base
+    {
+        template <class F>
+        explicit Callable(F &&f)
+            : fn{std::forward<F>(f)}
+        {}
+
+        void call(Args... args) override
+        {
+            fn(std::forward<Args>(args)...);
+        }
+
+        Fn fn;
+    };
+
+    std::unique_ptr<Base> _callable;
+};
+
+/**
+ * Owning state of the vfsm::AsyncContext job, bound in place when the job is posted
+ */
+struct JobBinding
+{
+    std::stop_token stop;
+    std::uint64_t   generation = 0;
+};
+
+template <class Fn>
+struct BoundJob : JobBinding
+{
+    explicit BoundJob(Fn &&f)
+        : fn{std::move(f)}
+    {}
+
+    void operator()()
+    {
+        fn(stop, generation);
+    }
+
+    Fn fn;
+};
+
+} // detail
+
+/**
+ * Fixed set of worker threads for the offloaded actions. Jobs queued before destruction are completed.
+ *
+ * Exception escaping the job terminates the program, as any exception leaving the thread function: catch inside the
+ * job to report it (see vfsm::JobFailed).
+ */
+class ThreadPool
+{
+public:
+    /// `threads` == 0 - std::thread::hardware_concurrency()
+    explicit ThreadPool(unsigned threads = 0)
+    {
+        if (threads == 0)
+            threads = std::max(1u, std::thread::hardware_concurrency());
+        _workers.reserve(threads);
+        for (unsigned i = 0; i < threads; ++i)
+            _workers.emplace_back([this](std::stop_token stop) { work(stop); });
+    }
+
+    ThreadPool(ThreadPool const&) = delete;
+    ThreadPool& operator=(ThreadPool const&) = delete;
+
+    ~ThreadPool()
+    {
+        for (auto &worker : _workers)
+            worker.request_stop();
+        _wakeup.notify_all();
+    }
+
+    template <class Job>
+    void post(Job &&job)
+    {
+        {
+            std::lock_guard lock{_mutex};
+            _jobs.emplace_back(std::forward<Job>(job));
+        }
+        _wakeup.notify_one();
+    }
+
+    std::size_t size() const noexcept
+    {
+        return _workers.size();
+    }
+
+private:
+    void work(std::stop_token stop)
+    {
+        while (true) {
+            detail::UniqueFunction<void()> job;
+            {
+                std::unique_lock lock{_mutex};
+                if (!_wakeup.wait(lock, stop, [this] { return !_jobs.empty(); }))
+                    return;
+                job = std::move(_jobs.front());
+                _jobs.pop_front();
+            }
+            job();
+        }
+    }
+
+private:
+    std::mutex                                 _mutex;
+    std::condition_variable_any                _wakeup;
+    std::deque<detail::UniqueFunction<void()>> _jobs;
+    // Last member: workers are joined before the queue is destroyed
+    std::vector<std::jthread>                  _workers;
+};
+
+/**
+ * Completion of the throwing job, delivered when listed in the vfsm::AsyncContext completions. Otherwise the exception
+ * terminates the program: the machine would wait for the completion forever.
+ */
+struct JobFailed
+{
+    std::exception_ptr error;
+};
+
+/**
+ * Multi-producer event queue of the machine: any thread posts, the machine thread dispatches.
+ */
+template <class... Events>
+class Mailbox
+{
+public:
+    using Event = std::variant<Events...>;
+
+    /**
+     * Post the event from any thread. Optional `stamp` is checked by dispatch() before processing.
+     */
+    template <class E>
+        requires (std::is_same_v<std::remove_cvref_t<E>, Events> || ...)
+    void post(E &&event, std::uint64_t stamp = 0)
+    {
+        std::lock_guard lock{_mutex};
+        _events.push_back({Event{std::in_place_type<std::remove_cvref_t<E>>, std::forward<E>(event)}, stamp});
+    }
+
+    /**
+     * Process all posted events by the machine, returns count of the processed events. Lock is held only to grab
+     * the batch.
+     */
+    template <class Machine>
+    std::size_t dispatch(Machine &sm)
+    {
+        return dispatch(sm, [](std::uint64_t) { return true; });
+    }
+
+    /**
+     * Same, but events with `accept(stamp) == false` are dropped. Predicate is checked right before each event.
+     */
+    template <class Machine, class Accept>
+    std::size_t dispatch(Machine &sm, Accept &&accept)
+    {
+        {
+            std::lock_guard lock{_mutex};
+            _batch.swap(_events);
+        }
+        std::size_t count = 0;
+        for (auto &[event, stamp] : _batch) {
+            if (!accept(stamp))
+                continue;
+            std::visit([&sm](auto &&ev) { sm.processEvent(std::move(ev)); }, event);
+            ++count;
+        }
+        _batch.clear();
+        return count;
+    }
+
+    bool empty() const
+    {
+        std::lock_guard lock{_mutex};
+        return _events.empty();
+    }
+
+private:
+    struct Entry
+    {
+        Event         event;
+        std::uint64_t stamp;
+    };
+
+    mutable std::mutex _mutex;
+    std::vector<Entry> _events;
+    // Dispatching thread only
+    std::vector<Entry> _batch;
+};
+
+/**
+ * Table context mixin for the offloaded actions: handler launches the slow job on the ThreadPool and returns into the
+ * waiting state immediately, event returned by the job is delivered back to the machine by dispatch().
+ *
+ * Job belongs to the state the machine is in after the launching event (the waiting state). Leaving that state, as
+ * well as the context reset or destruction, cancels the job: its `std::stop_token` (when the job accepts one) is
+ * signalled, and completion posted by the job after that is dropped by the generation check in dispatch().
+ *
+ * Relies on the Fsm onStateChange()/onEvent()/onStart() hooks: jobs launched by the event or by the initial OnEnter are
+ * posted to the pool after it is processed. Jobs launched outside of the machine are posted by flush().
+ *
+ * Sample:
+ * ```
+ * struct Context : vfsm::AsyncContext<Ev::Written>
+ * {
+ *     auto operator()()
+ *     {
+ *         return vfsm::overload{
+ *             [this](Idle, Ev::Write ev) -> Writing {
+ *                 launch([buf = ev.buf](std::stop_token stop) { save(buf, stop); return Ev::Written{}; });
+ *                 return {};
+ *             },
+ *             [](Writing, Ev::Written) -> Idle { return {}; },
+ *             [](Writing, Ev::Abort) -> Idle { return {}; } // cancels save()
+ *         };
+ *     }
+ * };
+ *
+ * Fsm sm{Context{pool}, Idle{}};
+ * ...
+ * sm.context().dispatch(sm); // in the machine thread
+ * ```
+ */
+template <class... Completions>
+class AsyncContext
+{
+public:
+    explicit AsyncContext(ThreadPool &pool)
+        : _pool{&pool},
+          _mailbox{std::make_shared<Mailbox<Completions...>>()}
+    {}
+
+    AsyncContext(AsyncContext &&) = default;
+
+    AsyncContext& operator=(AsyncContext &&other)
+    {
+        if (this != &other) {
+            _stop.request_stop();
+            _pool = other._pool;
+            _mailbox = std::move(other._mailbox);
+            _stop = std::move(other._stop);
+            _generation = other._generation;
+            _deferred = std::move(other._deferred);
+        }
+        return *this;
+    }
+
+    ~AsyncContext()
+    {
+        _stop.request_stop();
+    }
+
+    /**
+     * Run `job()` or `job(std::stop_token)` on the pool, its result (one of the `Completions`) is posted into the
+     * mailbox. The exception thrown by the job is posted as vfsm::JobFailed when it is one of the `Completions`.
+     */
+    template <class Job>
+        requires std::is_invocable_v<Job&> || std::is_invocable_v<Job&, std::stop_token>
+    void launch(Job &&job)
+    {
+        // Mailbox is shared: late completion outlives the context safely
+        auto body = [mailbox = _mailbox, job = std::forward<Job>(job)]
+                    (std::stop_token stop, std::uint64_t generation) mutable {
+            if (stop.stop_requested())
+                return;
+            auto complete = [&] {
+                if constexpr (std::is_invocable_v<Job&, std::stop_token>) {
+                    auto result = job(stop);
+                    if (!stop.stop_requested())
+                        mailbox->post(std::move(result), generation);
+                } else {
+                    auto result = job();
+                    if (!stop.stop_requested())
+                        mailbox->post(std::move(result), generation);
+                }
+            };
+            if constexpr ((std::is_same_v<Completions, JobFailed> || ...)) {
+                try {
+                    complete();
+                } catch (...) {
+                    if (!stop.stop_requested())
+                        mailbox->post(JobFailed{std::current_exception()}, generation);
+                }
+            } else {
+                complete();
+            }
+        };
+        detail::BoundJob<decltype(body)> *bound = nullptr;
+        auto fn = detail::UniqueFunction<void()>::make(bound, std::move(body));
+        _deferred.push_back({std::move(fn), bound});
+    }
+
+    /**
+     * Post the launched jobs to the pool, they belong to the current state. Called by the machine hooks, call it
+     * after launch() outside of the machine handlers.
+     */
+    void flush()
+    {
+        for (auto &deferred : _deferred) {
+            deferred.binding->stop = _stop.get_token();
+            deferred.binding->generation = _generation;
+            _pool->post(std::move(deferred.job));
+        }
+        _deferred.clear();
+    }
+
+    /**
+     * Deliver completions of the jobs of the current state to the machine, call from the thread owning the machine
+     */
+    template <class Machine>
+    std::size_t dispatch(Machine &sm)
+    {
+        return _mailbox->dispatch(sm, [this](std::uint64_t generation) { return generation == _generation; });
+    }
+
+    /**
+     * Cancel jobs of the current state
+     */
+    void cancel()
+    {
+        _stop.request_stop();
+        _stop = {};
+        ++_generation;
+    }
+
+    Mailbox<Completions...>& mailbox() noexcept
+    {
+        return *_mailbox;
+    }
+
+    //
+    // Fsm hooks
+    //
+    void onStateChange(std::size_t /*from*/, std::size_t /*to*/)
+    {
+        cancel();
+    }
+
+    template <class Event>
+    void onEvent(std::size_t /*state*/, bool /*handled*/)
+    {
+        flush();
+    }
+
+    void onStart(std::size_t /*state*/)
+    {
+        flush();
+    }
+
+private:
+    struct Deferred
+    {
+        detail::UniqueFunction<void()> job;
+        // Inside the job allocation
+        detail::JobBinding            *binding;
+    };
+
+    ThreadPool                              *_pool;
+    std::shared_ptr<Mailbox<Completions...>> _mailbox;
+    std::stop_source                         _stop;
+    std::uint64_t                            _generation = 0;
+    // Launched by the event in progress, the owning state is not known yet
+    std::vector<Deferred>                    _deferred;
+};
+
+} // vfsm
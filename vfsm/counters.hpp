@@ -0,0 +1,227 @@
+//
+// Distributed under MIT license.
+//
+// Copyright 2024 Alexander Drozdov <adrozdoff@gmail.com>
+// Author: Alexander Drozdov <adrozdoff@gmail.com>
+// Site:   https://github.com/h4tr3d/fsm_variant/
+//
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <span>
+#include <string>
+#include <string_view>
+
+#include "vfsm.hpp"
+
+namespace vfsm {
+
+/**
+ * Transition statistics shared by any number of machines of the same table, possibly running in different threads.
+ *
+ * Counters are relaxed atomics sized at compile time: state entries, handled events per (source state, event) and
+ * unhandled events per state. Events outside of the `Events` list and poll() are counted in the extra "other" column.
+ * Every thread increments its own cache-line aligned shard, readers sum the shards.
+ *
+ * Sample:
+ * ```
+ * using Stats = vfsm::Counters<3, Ev::Connect, Ev::Ack, Ev::Close>;
+ * Stats stats;
+ * Fsm sm{Context{stats}, Idle{}}; // Context derives from vfsm::CountingContext<Stats>
+ * ...
+ * stats.exportPrometheus(std::cout, "session", Fsm::state_names, vfsm::type_names<Ev::Connect, Ev::Ack, Ev::Close>);
+ * ```
+ */
+template <std::size_t StateCount, class... Events>
+class Counters
+{
+public:
+    static constexpr std::size_t state_count = StateCount;
+    /// Events columns, the last one is "other"
+    static constexpr std::size_t event_count = sizeof...(Events) + 1;
+    /// Threads over this count share the shards
+    static constexpr std::size_t shard_count = 16;
+
+    Counters() = default;
+    Counters(Counters const&) = delete;
+    Counters& operator=(Counters const&) = delete;
+
+    template <class Event>
+    static constexpr std::size_t event_index() noexcept
+    {
+        return detail::index_of<Event, Events...>();
+    }
+
+    void entered(std::size_t state) noexcept
+    {
+        _shards[shard()].entries[state].fetch_add(1, std::memory_order_relaxed);
+    }
+
+    template <class Event>
+    void processed(std::size_t state, bool handled) noexcept
+    {
+        auto &shard = _shards[Counters::shard()];
+        if (handled)
+            shard.hits[state * event_count + event_index<Event>()].fetch_add(1, std::memory_order_relaxed);
+        else
+            shard.unhandled[state].fetch_add(1, std::memory_order_relaxed);
+    }
+
+    std::uint64_t entries(std::size_t state) const noexcept
+    {
+        return sum(&Shard::entries, state);
+    }
+
+    std::uint64_t hits(std::size_t state, std::size_t event) const noexcept
+    {
+        return sum(&Shard::hits, state * event_count + event);
+    }
+
+    std::uint64_t unhandled(std::size_t state) const noexcept
+    {
+        return sum(&Shard::unhandled, state);
+    }
+
+    /**
+     * Write counters in the Prometheus text exposition format, labelled by `machine`. Missed state and event names
+     * are replaced by the indexes, label values are escaped.
+     */
+    void exportPrometheus(std::ostream &out,
+                          std::string_view machine,
+                          std::span<std::string_view const> stateNames = {},
+                          std::span<std::string_view const> eventNames = {}) const
+    {
+        auto name = [](std::span<std::string_view const> names, std::size_t i) {
+            return i < names.size() ? labelValue(names[i]) : std::to_string(i);
+        };
+        auto state = [&](std::size_t i) {
+            return "{machine=\"" + labelValue(machine) + "\",state=\"" + name(stateNames, i) + "\"";
+        };
+
+        out << "# HELP vfsm_state_entries_total State entries by transitions.\n"
+               "# TYPE vfsm_state_entries_total counter\n";
+        for (std::size_t s = 0; s < StateCount; ++s)
+            out << "vfsm_state_entries_total" << state(s) << "} " << entries(s) << '\n';
+
+        out << "# HELP vfsm_events_total Events handled in the state.\n"
+               "# TYPE vfsm_events_total counter\n";
+        for (std::size_t s = 0; s < StateCount; ++s) {
+            for (std::size_t e = 0; e < event_count; ++e) {
+                auto const count = hits(s, e);
+                if (count == 0)
+                    continue;
+                out << "vfsm_events_total" << state(s) << ",event=\""
+                    << (e + 1 == event_count ? std::string{"other"} : name(eventNames, e)) << "\"} " << count << '\n';
+            }
+        }
+
+        out << "# HELP vfsm_unhandled_events_total Events without handler in the state.\n"
+               "# TYPE vfsm_unhandled_events_total counter\n";
+        for (std::size_t s = 0; s < StateCount; ++s)
+            out << "vfsm_unhandled_events_total" << state(s) << "} " << unhandled(s) << '\n';
+    }
+
+private:
+    struct alignas(64) Shard
+    {
+        std::array<std::atomic<std::uint64_t>, StateCount>               entries{};
+        std::array<std::atomic<std::uint64_t>, StateCount * event_count> hits{};
+        std::array<std::atomic<std::uint64_t>, StateCount>               unhandled{};
+    };
+
+    // Label value escaping of the text exposition format
+    static std::string labelValue(std::string_view value)
+    {
+        std::string escaped;
+        escaped.reserve(value.size());
+        for (auto c : value) {
+            switch (c) {
+                case '\\':
+                    escaped += "\\\\";
+                    break;
+                case '"':
+                    escaped += "\\\"";
+                    break;
+                case '\n':
+                    escaped += "\\n";
+                    break;
+                default:
+                    escaped += c;
+            }
+        }
+        return escaped;
+    }
+
+    static std::size_t shard() noexcept
+    {
+        static std::atomic<std::size_t> s_next{0};
+        thread_local std::size_t const index = s_next.fetch_add(1, std::memory_order_relaxed) % shard_count;
+        return index;
+    }
+
+    template <class Array>
+    std::uint64_t sum(Array Shard::*counters, std::size_t i) const noexcept
+    {
+        std::uint64_t total = 0;
+        for (auto const& shard : _shards)
+            total += (shard.*counters)[i].load(std::memory_order_relaxed);
+        return total;
+    }
+
+private:
+    std::array<Shard, shard_count> _shards{};
+};
+
+/**
+ * Table context mixin updating the shared vfsm::Counters from the Fsm onStateChange()/onEvent() hooks: one increment
+ * per event, one more per state change.
+ *
+ * When the context defines its own hooks, call the CountingContext ones from them.
+ */
+template <class Stats>
+class CountingContext
+{
+public:
+    explicit CountingContext(Stats &stats)
+        : _stats{&stats}
+    {}
+
+    Stats& stats() const noexcept
+    {
+        return *_stats;
+    }
+
+    //
+    // Fsm hooks
+    //
+    void onStateChange(std::size_t from, std::size_t to) noexcept
+    {
+        _stats->entered(to);
+        _from = from;
+    }
+
+    template <class Event>
+    void onEvent(std::size_t state, bool handled) noexcept
+    {
+        // Hits are counted for the source state
+        if (_from != s_none) {
+            state = _from;
+            _from = s_none;
+        }
+        _stats->template processed<Event>(state, handled);
+    }
+
+private:
+    static constexpr std::size_t s_none = ~std::size_t(0);
+
+    Stats       *_stats;
+    // Source state of the event in progress, when it changes the state
+    std::size_t  _from = s_none;
+};
+
+} // vfsm
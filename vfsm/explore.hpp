@@ -0,0 +1,311 @@
+//
+// Distributed under MIT license.
+//
+// Copyright 2024 Alexander Drozdov <adrozdoff@gmail.com>
+// Author: Alexander Drozdov <adrozdoff@gmail.com>
+// Site:   https://github.com/h4tr3d/fsm_variant/
+//
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "vfsm.hpp"
+
+namespace vfsm {
+
+struct ExploreOptions
+{
+    enum class Order
+    {
+        Bfs, ///< Breadth-first per worker (global level order is approximate with several threads)
+        Dfs, ///< Depth-first per worker
+    };
+
+    Order order = Order::Bfs;
+    /// Worker threads count, 0 - std::thread::hardware_concurrency()
+    unsigned threads = 0;
+    /// Stop after given count of unique configurations, 0 - unlimited
+    std::size_t maxConfigurations = 0;
+    /// Do not expand configurations deeper than given, 0 - unlimited
+    std::size_t maxDepth = 0;
+};
+
+struct ExploreResult
+{
+    /// Unique configurations (state index + context hash) reached, including initial one
+    std::size_t configurations = 0;
+    /// Events handled over all expanded configurations
+    std::size_t transitions = 0;
+    /// Maximum depth (events count from the initial configuration) reached
+    std::size_t depth = 0;
+    /// Whole reachable space was explored: no limits hit and visitor did not stop exploration
+    bool complete = true;
+};
+
+namespace detail {
+
+struct ExploreKey
+{
+    std::size_t   state;
+    std::uint64_t hash;
+
+    bool operator==(ExploreKey const&) const = default;
+};
+
+struct ExploreKeyHash
+{
+    std::size_t operator()(ExploreKey const& key) const noexcept
+    {
+        // splitmix64 finalizer over combined value
+        std::uint64_t x = key.hash ^ (std::uint64_t(key.state) * 0x9e3779b97f4a7c15ull);
+        x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+        x = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+        return x ^ (x >> 31);
+    }
+};
+
+//
+// Visited configurations set: lock-striped shards
+//
+class ExploreVisited
+{
+    struct alignas(64) Shard
+    {
+        std::mutex                                     lock;
+        std::unordered_set<ExploreKey, ExploreKeyHash> set;
+    };
+
+public:
+    explicit ExploreVisited(std::size_t shards)
+        : _shards(std::bit_ceil(shards))
+    {}
+
+    bool insert(ExploreKey const& key)
+    {
+        auto const h = ExploreKeyHash{}(key);
+        auto &shard = _shards[(h >> 7) & (_shards.size() - 1)];
+        std::lock_guard lock{shard.lock};
+        return shard.set.insert(key).second;
+    }
+
+private:
+    std::vector<Shard> _shards;
+};
+
+//
+// Per-worker frontier: owner takes from one end according to the order, thieves take the oldest items
+//
+template <class Item>
+class ExploreFrontier
+{
+public:
+    void push(Item &&item)
+    {
+        std::lock_guard lock{_lock};
+        _items.push_back(std::move(item));
+    }
+
+    bool pop(Item &item, ExploreOptions::Order order)
+    {
+        std::lock_guard lock{_lock};
+        if (_items.empty())
+            return false;
+        if (order == ExploreOptions::Order::Dfs) {
+            item = std::move(_items.back());
+            _items.pop_back();
+        } else {
+            item = std::move(_items.front());
+            _items.pop_front();
+        }
+        return true;
+    }
+
+    bool steal(Item &item)
+    {
+        std::lock_guard lock{_lock};
+        if (_items.empty())
+            return false;
+        item = std::move(_items.front());
+        _items.pop_front();
+        return true;
+    }
+
+private:
+    std::mutex       _lock;
+    std::deque<Item> _items;
+};
+
+} // detail
+
+/**
+ * Explore reachable configurations of the machine
+ *
+ * Configuration is a pair of the current state index and user-provided hash of the context. Starting from the
+ * `initial` machine every event of the `alphabet` is tried against the fork of every new configuration. Work is spread
+ * over worker threads with per-worker frontiers and work stealing, visited configurations are kept in the lock-striped
+ * concurrent hash set. Counters are per worker, the workers synchronize only when they run out of work.
+ *
+ * `contextHash` is `std::uint64_t(Context const&)`, configurations with equal state index and context hash are treated
+ * as the same one. `visitor` is `bool(Machine const&, std::size_t depth)`, called once per new configuration, possibly
+ * concurrently from the several threads; return `false` to stop exploration (e.g. on invariant violation).
+ *
+ * Sample:
+ * ```
+ * auto result = vfsm::explore(MyFsm{Ctx{}, Idle{}}, std::tuple{EvSend{}, EvAck{}, EvTimeout{}},
+ *                             [](Ctx const& c) { return std::uint64_t(c.seq) << 8 | c.retries; },
+ *                             [](MyFsm const& sm, std::size_t) { return sm.context().retries <= 3; });
+ * ```
+ */
+template <class Machine, class... Events, class ContextHash, class Visitor>
+    requires std::is_invocable_r_v<bool, Visitor&, Machine const&, std::size_t>
+ExploreResult explore(Machine const& initial, std::tuple<Events...> const& alphabet, ContextHash &&contextHash,
+                      Visitor &&visitor, ExploreOptions const& opts = {})
+{
+    struct Item
+    {
+        Machine     sm;
+        std::size_t depth;
+    };
+
+    // Owner-only counters are merged at the end, the frontier is shared with the thieves
+    struct alignas(64) Worker
+    {
+        std::size_t configurations = 0;
+        std::size_t transitions = 0;
+        std::size_t depth = 0;
+        alignas(64) detail::ExploreFrontier<Item> frontier;
+    };
+
+    auto const threads = opts.threads ? opts.threads : std::max(1u, std::thread::hardware_concurrency());
+
+    detail::ExploreVisited visited{threads * 16};
+    std::vector<Worker> workers(threads);
+
+    // Shared state is touched out of work or on limits only, not per configuration
+    std::atomic<unsigned> idle{0};
+    std::atomic<std::size_t> limited{0};
+    std::atomic<bool> stop{false};
+    std::atomic<bool> truncated{false};
+
+    auto keyOf = [&](Machine const& sm) {
+        return detail::ExploreKey{sm.state_index(), std::uint64_t(contextHash(sm.context()))};
+    };
+
+    // Returns false when exploration must stop
+    auto discover = [&](Machine &&sm, std::size_t depth, unsigned worker) {
+        if (!visited.insert(keyOf(sm)))
+            return true;
+
+        auto &self = workers[worker];
+        ++self.configurations;
+        self.depth = std::max(self.depth, depth);
+
+        if (!visitor(std::as_const(sm), depth))
+            return false;
+
+        if (opts.maxConfigurations &&
+            limited.fetch_add(1, std::memory_order_relaxed) + 1 >= opts.maxConfigurations) {
+            truncated = true;
+            return false;
+        }
+
+        if (opts.maxDepth && depth >= opts.maxDepth) {
+            truncated = true;
+            return true;
+        }
+
+        self.frontier.push(Item{std::move(sm), depth});
+        return true;
+    };
+
+    auto expand = [&](Item const& item, unsigned worker) {
+        std::apply([&](auto const&... events) {
+            auto tryEvent = [&](auto event) {
+                if (stop.load(std::memory_order_relaxed))
+                    return;
+                auto next = item.sm.fork();
+                if (!next.processEvent(std::move(event)))
+                    return;
+                ++workers[worker].transitions;
+                if (!discover(std::move(next), item.depth + 1, worker))
+                    stop = true;
+            };
+            (tryEvent(events), ...);
+        }, alphabet);
+    };
+
+    // Idle worker holds no item and only the owner pushes to its frontier: all workers idle - the space is exhausted
+    auto work = [&](unsigned worker) {
+        Item current{initial.fork(), 0};
+        while (!stop.load(std::memory_order_relaxed)) {
+            if (workers[worker].frontier.pop(current, opts.order)) {
+                expand(current, worker);
+                continue;
+            }
+
+            bool found = false;
+            idle.fetch_add(1, std::memory_order_acq_rel);
+            while (!found && !stop.load(std::memory_order_relaxed)) {
+                if (idle.load(std::memory_order_acquire) == threads)
+                    return;
+                idle.fetch_sub(1, std::memory_order_acq_rel);
+                for (unsigned i = 1; !found && i < threads; ++i)
+                    found = workers[(worker + i) % threads].frontier.steal(current);
+                if (!found) {
+                    idle.fetch_add(1, std::memory_order_acq_rel);
+                    std::this_thread::yield();
+                }
+            }
+            if (found)
+                expand(current, worker);
+        }
+    };
+
+    if (!discover(initial.fork(), 0, 0))
+        stop = true;
+
+    if (threads == 1) {
+        work(0);
+    } else {
+        std::vector<std::jthread> pool;
+        pool.reserve(threads);
+        for (unsigned i = 0; i < threads; ++i)
+            pool.emplace_back(work, i);
+    }
+
+    ExploreResult result{};
+    for (auto const& w : workers) {
+        result.configurations += w.configurations;
+        result.transitions += w.transitions;
+        result.depth = std::max(result.depth, w.depth);
+    }
+    result.complete = !stop.load() && !truncated.load();
+    return result;
+}
+
+/**
+ * Same as above without per-configuration visitor
+ */
+template <class Machine, class... Events, class ContextHash>
+ExploreResult explore(Machine const& initial, std::tuple<Events...> const& alphabet, ContextHash &&contextHash,
+                      ExploreOptions const& opts = {})
+{
+    return explore(initial, alphabet, std::forward<ContextHash>(contextHash),
+                   [](Machine const&, std::size_t) { return true; }, opts);
+}
+
+} // vfsm
@@ -0,0 +1,122 @@
+//
+// Distributed under MIT license.
+//
+// Copyright 2024 Alexander Drozdov <adrozdoff@gmail.com>
+// Author: Alexander Drozdov <adrozdoff@gmail.com>
+// Site:   https://github.com/h4tr3d/fsm_variant/
+//
+
+#pragma once
+
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <vector>
+
+#include "vfsm.hpp"
+
+namespace vfsm {
+
+/**
+ * Recycling storage for machine forks
+ *
+ * Forks are placed into the slots allocated by chunks and returned back to the free list when handle is destroyed, so
+ * the steady-state forking does not touch the heap. Trivially copyable machines are copied into the slot by raw
+ * `memcpy`, like Fsm::fork().
+ *
+ * Pool is not thread-safe, use one pool per thread. Pool must outlive all handles.
+ *
+ * Sample:
+ * ```
+ * vfsm::ForkPool<MyFsm> pool;
+ *
+ * bool admit(MyFsm const& sm, std::span<const EvPacket> burst) {
+ *   auto probe = pool.fork(sm);
+ *   for (auto ev : burst)
+ *     probe->processEvent(ev);
+ *   return probe->state_index() != failIndex;
+ * } // probe storage returned to the pool
+ * ```
+ */
+template <class Machine>
+class ForkPool
+{
+    struct Slot
+    {
+        alignas(Machine) unsigned char storage[sizeof(Machine)];
+    };
+
+    struct Release
+    {
+        ForkPool *pool;
+
+        void operator()(Machine *sm) const noexcept
+        {
+            pool->release(sm);
+        }
+    };
+
+public:
+    using Handle = std::unique_ptr<Machine, Release>;
+
+    explicit ForkPool(std::size_t initialCapacity = 64)
+    {
+        grow(initialCapacity ? initialCapacity : 1);
+    }
+
+    ForkPool(ForkPool const&) = delete;
+    ForkPool& operator=(ForkPool const&) = delete;
+
+    Handle fork(Machine const& sm)
+    {
+        if (_free.empty())
+            grow(_capacity);
+
+        auto slot = _free.back();
+        Machine *copy;
+        if constexpr (std::is_trivially_copyable_v<Machine>) {
+            std::memcpy(slot->storage, &sm, sizeof(Machine));
+            copy = std::launder(reinterpret_cast<Machine*>(slot->storage));
+        } else {
+            copy = ::new (static_cast<void*>(slot->storage)) Machine(sm);
+        }
+        _free.pop_back();
+        return Handle{copy, Release{this}};
+    }
+
+    std::size_t capacity() const noexcept
+    {
+        return _capacity;
+    }
+
+    std::size_t available() const noexcept
+    {
+        return _free.size();
+    }
+
+private:
+    void grow(std::size_t count)
+    {
+        auto &chunk = _chunks.emplace_back(std::make_unique<Slot[]>(count));
+        _free.reserve(_capacity + count);
+        for (std::size_t i = count; i > 0; --i)
+            _free.push_back(&chunk[i - 1]);
+        _capacity += count;
+    }
+
+    void release(Machine *sm) noexcept
+    {
+        if constexpr (!std::is_trivially_destructible_v<Machine>)
+            sm->~Machine();
+        _free.push_back(reinterpret_cast<Slot*>(sm));
+    }
+
+private:
+    std::vector<std::unique_ptr<Slot[]>> _chunks;
+    std::vector<Slot*>                   _free;
+    std::size_t                          _capacity = 0;
+};
+
+} // vfsm
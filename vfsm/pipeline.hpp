@@ -0,0 +1,90 @@
+//
+// Distributed under MIT license.
+//
+// Copyright 2024 Alexander Drozdov <adrozdoff@gmail.com>
+// Author: Alexander Drozdov <adrozdoff@gmail.com>
+// Site:   https://github.com/h4tr3d/fsm_variant/
+//
+
+#pragma once
+
+#include <utility>
+
+#include "vfsm.hpp"
+
+namespace vfsm {
+
+/**
+ * Output selector: `(State, vfsm::Output) -> Event` handler gives the event passed to the next machine of the
+ * vfsm::Pipeline after every handled event that leaves the machine in the `State`.
+ */
+struct Output {};
+
+/**
+ * Two machines chained by the outputs: output events of the `Upstream` machine are processed by the `Downstream` one.
+ * Each machine keeps its own dispatch, so the precomputed transitions (see vfsm::pure) work on both sides.
+ *
+ * Sample:
+ * ```
+ * // framer: ... vfsm::pure([](FrameEnd, vfsm::Output) { return Ev::Frame{}; }) ...
+ * vfsm::Pipeline stack{FramerFsm{Framer{}, Idle{}}, SessionFsm{Session{}, Closed{}}};
+ * for (auto byte : input)
+ *     stack.processEvent(Ev::Byte{byte});
+ * ```
+ */
+template <class Upstream, class Downstream>
+class Pipeline
+{
+public:
+    constexpr Pipeline(Upstream &&upstream, Downstream &&downstream)
+        : _up{std::move(upstream)},
+          _down{std::move(downstream)}
+    {}
+
+    /**
+     * Returns true when the upstream machine handled the event
+     */
+    template <typename Event>
+    constexpr bool processEvent(Event &&event)
+    {
+        if (!_up.processEvent(std::forward<Event>(event)))
+            return false;
+        emit();
+        return true;
+    }
+
+    auto const& upstream() const
+    {
+        return _up;
+    }
+
+    auto& upstream()
+    {
+        return _up;
+    }
+
+    auto const& downstream() const
+    {
+        return _down;
+    }
+
+    auto& downstream()
+    {
+        return _down;
+    }
+
+private:
+    constexpr void emit()
+    {
+        _up.visit([this](auto &state) {
+            if constexpr (requires { _up.context()()(state, Output{}); })
+                _down.processEvent(unpure(_up.context()()(state, Output{})));
+        });
+    }
+
+private:
+    Upstream   _up;
+    Downstream _down;
+};
+
+} // vfsm
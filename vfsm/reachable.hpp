@@ -0,0 +1,170 @@
+//
+// Distributed under MIT license.
+//
+// Copyright 2024 Alexander Drozdov <adrozdoff@gmail.com>
+// Author: Alexander Drozdov <adrozdoff@gmail.com>
+// Site:   https://github.com/h4tr3d/fsm_variant/
+//
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <variant>
+
+#include "vfsm.hpp"
+
+namespace vfsm {
+
+namespace detail {
+
+template <class Result, class... States>
+constexpr void markTargets(bool (&row)[sizeof...(States) + 1], std::size_t self)
+{
+    if constexpr (std::is_void_v<Result>) {
+        row[self] = true;
+    } else if constexpr (requires { std::variant_size<Result>::value; }) {
+        [&]<std::size_t... I>(std::index_sequence<I...>) {
+            ((row[index_of<std::variant_alternative_t<I, Result>, States...>()] = true), ...);
+        }(std::make_index_sequence<std::variant_size_v<Result>>{});
+    } else {
+        row[index_of<Result, States...>()] = true;
+    }
+}
+
+} // detail
+
+/**
+ * Compile-time reachability analysis of the transition table.
+ *
+ * Transitions are taken from the handler result types for every event of the `Events` alphabet (`std::tuple<...>`)
+ * and from the poll handlers, so every alternative of the `std::variant` result is treated as reachable. Search
+ * starts from the `Initial` state. Duplicates in the `States` list are ignored.
+ *
+ * Sample:
+ * ```
+ * using Reach = vfsm::Reachability<Context, std::tuple<EvStart, EvStop>, Idle, Idle, Run, Stop, Fail>;
+ * static_assert(Reach::unreachable_count == 0, "Dead states in the table");
+ * ```
+ */
+template <class TableContext, class Events, class Initial, class... States>
+struct Reachability;
+
+template <class TableContext, class... Events, class Initial, class... States>
+struct Reachability<TableContext, std::tuple<Events...>, Initial, States...>
+{
+    static_assert(detail::index_of<Initial, States...>() < sizeof...(States), "Initial state is not in the list");
+
+private:
+    static constexpr std::size_t N = sizeof...(States);
+
+    template <class State, class... Event>
+    static constexpr void markTargets(bool (&row)[N + 1])
+    {
+        constexpr auto self = detail::index_of<State, States...>();
+        if constexpr (requires (TableContext &ctx, State &s, Event &...e) { ctx()(s, e...); }) {
+            using Result = std::remove_cvref_t<decltype(unpure(std::declval<TableContext&>()()(std::declval<State&>(),
+                                                                                              std::declval<Event&>()...)))>;
+            detail::markTargets<Result, States...>(row, self);
+        }
+    }
+
+    template <class State>
+    static constexpr auto targets()
+    {
+        // Extra element collects results outside of the state list
+        bool row[N + 1] = {};
+        markTargets<State>(row); // poll
+        (markTargets<State, Events>(row), ...);
+
+        std::array<bool, N> result{};
+        for (std::size_t i = 0; i < N; ++i)
+            result[i] = row[i];
+        return result;
+    }
+
+    static constexpr auto search()
+    {
+        constexpr std::array<std::array<bool, N>, N> edges = {targets<States>()...};
+
+        std::array<bool, N> seen{};
+        std::array<std::size_t, N> queue{};
+        std::size_t head = 0, tail = 0;
+
+        seen[detail::index_of<Initial, States...>()] = true;
+        queue[tail++] = detail::index_of<Initial, States...>();
+        while (head < tail) {
+            auto const from = queue[head++];
+            for (std::size_t to = 0; to < N; ++to) {
+                if (edges[from][to] && !seen[to]) {
+                    seen[to] = true;
+                    queue[tail++] = to;
+                }
+            }
+        }
+
+        // Only the first occurrence of the duplicated state is kept
+        constexpr std::size_t first[] = {detail::index_of<States, States...>()..., 0};
+        for (std::size_t i = 0; i < N; ++i)
+            seen[i] = seen[i] && first[i] == i;
+        return seen;
+    }
+
+    static constexpr auto s_keep = search();
+
+    template <std::size_t... I>
+    static constexpr auto keptStates(std::index_sequence<I...>)
+        -> decltype(std::tuple_cat(std::conditional_t<s_keep[I], std::tuple<States>, std::tuple<>>{}...));
+
+    template <std::size_t... I>
+    static constexpr auto droppedStates(std::index_sequence<I...>)
+        -> decltype(std::tuple_cat(std::conditional_t<!s_keep[I] && detail::index_of<States, States...>() == I,
+                                                      std::tuple<States>, std::tuple<>>{}...));
+
+public:
+    /// Reachable states in the declaration order, without duplicates
+    using reachable = decltype(keptStates(std::index_sequence_for<States...>{}));
+    /// Declared but never entered states
+    using unreachable = decltype(droppedStates(std::index_sequence_for<States...>{}));
+
+    static constexpr std::size_t unreachable_count = std::tuple_size_v<unreachable>;
+
+    /// Is the state at the given position of the declared list kept
+    static constexpr bool is_reachable(std::size_t declared) noexcept
+    {
+        return s_keep[declared];
+    }
+};
+
+namespace detail {
+
+template <class TableContext, class StateList>
+struct FsmOf;
+
+template <class TableContext, class... States>
+struct FsmOf<TableContext, std::tuple<States...>>
+{
+    using type = Fsm<TableContext, States...>;
+};
+
+} // detail
+
+/**
+ * Fsm built over the reachable states only: storage variant and dispatch tables do not include dead or duplicated
+ * states, and the state index type shrinks with the states count.
+ *
+ * Sample:
+ * ```
+ * using Machine = vfsm::ReachableFsm<Context, std::tuple<EvStart, EvStop>, Idle, Idle, Run, Stop, Fail>;
+ * Machine sm{Context{}, Idle{}};
+ * ```
+ */
+template <class TableContext, class Events, class Initial, class... States>
+using ReachableFsm =
+    typename detail::FsmOf<TableContext,
+                           typename Reachability<TableContext, Events, Initial, States...>::reachable>::type;
+
+} // vfsm
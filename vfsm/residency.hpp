@@ -0,0 +1,190 @@
+//
+// Distributed under MIT license.
+//
+// Copyright 2024 Alexander Drozdov <adrozdoff@gmail.com>
+// Author: Alexander Drozdov <adrozdoff@gmail.com>
+// Site:   https://github.com/h4tr3d/fsm_variant/
+//
+
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <limits>
+#include <vector>
+
+#include "vfsm.hpp"
+
+namespace vfsm {
+
+/**
+ * Stuck state detector over the pool of machines.
+ *
+ * Every watched machine owns the slot in the deadline column: state entry time plus the residency limit of that state,
+ * written on the state change (see vfsm::Residency). The scan is a single comparison per machine over the contiguous
+ * column, independent of the states count.
+ *
+ * Sample:
+ * ```
+ * vfsm::Watchdog<3> watchdog{{vfsm::Watchdog<3>::unlimited, 5s, 60s}};
+ * sm.context().watch(watchdog, watchdog.add());
+ * ...
+ * watchdog.scan(std::chrono::steady_clock::now(), [&](std::size_t slot) { kill(slot); });
+ * ```
+ */
+template <std::size_t StateCount, class Clock = std::chrono::steady_clock>
+class Watchdog
+{
+public:
+    using duration = typename Clock::duration;
+    using time_point = typename Clock::time_point;
+    using rep = typename duration::rep;
+
+    static constexpr duration unlimited = duration::max();
+
+    /// Residency limit per state index, `unlimited` disables the check for the state
+    explicit Watchdog(std::array<duration, StateCount> const& limits)
+        : _limits{limits}
+    {}
+
+    /// New slot, not armed until the machine reports its state
+    std::size_t add()
+    {
+        _deadlines.push_back(s_never);
+        return _deadlines.size() - 1;
+    }
+
+    std::size_t size() const noexcept
+    {
+        return _deadlines.size();
+    }
+
+    /// Machine in the `slot` entered the `state` at `entered`
+    void arm(std::size_t slot, std::size_t state, time_point entered) noexcept
+    {
+        auto const limit = _limits[state];
+        auto const since = entered.time_since_epoch().count();
+        _deadlines[slot] = limit == unlimited || since > s_never - limit.count() ? s_never : since + limit.count();
+    }
+
+    void disarm(std::size_t slot) noexcept
+    {
+        _deadlines[slot] = s_never;
+    }
+
+    /**
+     * Call `stuck(slot)` for every machine over its state residency limit at `now`, returns the count
+     */
+    template <class Fn>
+    std::size_t scan(time_point now, Fn &&stuck) const
+    {
+        auto const ticks = now.time_since_epoch().count();
+        auto const size = _deadlines.size();
+        auto const *deadlines = _deadlines.data();
+        std::size_t count = 0;
+        auto check = [&](std::size_t begin, std::size_t end) {
+            for (std::size_t slot = begin; slot < end; ++slot) {
+                if (deadlines[slot] < ticks) {
+                    stuck(slot);
+                    ++count;
+                }
+            }
+        };
+        // Branchless check of the whole block is vectorized, expired slots are rare
+        std::size_t block = 0;
+        for (; block + s_block <= size; block += s_block) {
+            unsigned expired = 0;
+            for (std::size_t i = 0; i < s_block; ++i)
+                expired |= deadlines[block + i] < ticks;
+            if (expired) [[unlikely]]
+                check(block, block + s_block);
+        }
+        check(block, size);
+        return count;
+    }
+
+private:
+    static constexpr rep s_never = std::numeric_limits<rep>::max();
+    static constexpr std::size_t s_block = 64;
+
+    std::array<duration, StateCount> _limits;
+    // Column of the per-machine deadlines, Clock ticks since epoch
+    std::vector<rep>                 _deadlines;
+};
+
+/**
+ * Table context mixin for the time-in-state accounting: timestamps every state entry via the Fsm onStart() and
+ * onStateChange() hooks and accumulates residency time per state. Optionally keeps the vfsm::Watchdog slot of the
+ * machine armed.
+ *
+ * When the context defines its own onStart() or onStateChange(), call the Residency one from it.
+ *
+ * Sample:
+ * ```
+ * struct Context : vfsm::Residency<3> { auto operator()() { ... } };
+ *
+ * Fsm sm{Context{}, Idle{}};
+ * ...
+ * auto const busy = sm.context().residency(Fsm::index_of<Busy>());
+ * ```
+ */
+template <std::size_t StateCount, class Clock = std::chrono::steady_clock>
+class Residency
+{
+public:
+    using duration = typename Clock::duration;
+    using time_point = typename Clock::time_point;
+
+    /**
+     * Report state changes to the watchdog slot, starting from the current state
+     */
+    void watch(Watchdog<StateCount, Clock> &watchdog, std::size_t slot)
+    {
+        _watchdog = &watchdog;
+        _slot = slot;
+        _watchdog->arm(_slot, _state, _entered);
+    }
+
+    /// Total time spent in the state, including the current stay
+    duration residency(std::size_t state, time_point now = Clock::now()) const
+    {
+        return state == _state ? _total[state] + (now - _entered) : _total[state];
+    }
+
+    time_point entered() const noexcept
+    {
+        return _entered;
+    }
+
+    //
+    // Fsm hooks
+    //
+    void onStart(std::size_t state)
+    {
+        _entered = Clock::now();
+        _state = state;
+        if (_watchdog)
+            _watchdog->arm(_slot, state, _entered);
+    }
+
+    void onStateChange(std::size_t from, std::size_t to)
+    {
+        auto const now = Clock::now();
+        _total[from] += now - _entered;
+        _entered = now;
+        _state = to;
+        if (_watchdog)
+            _watchdog->arm(_slot, to, now);
+    }
+
+private:
+    std::array<duration, StateCount> _total{};
+    // Set by the machine start
+    time_point                       _entered{};
+    std::size_t                      _state = 0;
+    Watchdog<StateCount, Clock>     *_watchdog = nullptr;
+    std::size_t                      _slot = 0;
+};
+
+} // vfsm
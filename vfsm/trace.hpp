@@ -0,0 +1,394 @@
+//
+// Distributed under MIT license.
+//
+// Copyright 2024 Alexander Drozdov <adrozdoff@gmail.com>
+// Author: Alexander Drozdov <adrozdoff@gmail.com>
+// Site:   https://github.com/h4tr3d/fsm_variant/
+//
+
+#pragma once
+
+#include <atomic>
+#include <charconv>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <limits>
+#include <ostream>
+#include <span>
+#include <string_view>
+#include <vector>
+
+#include "vfsm.hpp"
+
+namespace vfsm {
+
+/**
+ * Single entry of the transition recorder, times are std::chrono::steady_clock nanoseconds
+ */
+struct TraceRecord
+{
+    enum Kind : std::uint8_t
+    {
+        Transition, // `from` -> `to`, `from` was entered at `since` (negative - unknown, see vfsm::TraceSampler)
+        Event,      // `event` processed, machine is in the `to` state after it
+    };
+
+    Kind          kind = Transition;
+    bool          handled = false;
+    std::uint32_t machine = 0;
+    std::uint32_t from = 0;
+    std::uint32_t to = 0;
+    std::uint32_t event = 0;
+    std::int64_t  since = 0;
+    std::int64_t  time = 0;
+};
+
+/**
+ * Sampling policy of the vfsm::TracingContext: one of every `period` events is recorded, together with the transition
+ * it caused, and transitions into or out of the rare states are always recorded. Every machine counts its own events,
+ * so one sampler serves any number of machines and threads; new period takes effect on the next event.
+ *
+ * Entry time of the state entered by the dropped transition is not known, such spans become instants.
+ *
+ * Sample:
+ * ```
+ * vfsm::TraceSampler sampler{100, {Fsm::index_of<Refused>()}};
+ * Fsm sm{Context{trace, 0, sampler}, Idle{}};
+ * ...
+ * sampler.setPeriod(1000); // from any thread
+ * ```
+ */
+class TraceSampler
+{
+public:
+    /// `period` 1 - every event, `rare` - state indexes
+    explicit TraceSampler(std::uint32_t period = 1, std::initializer_list<std::size_t> rare = {})
+        : _period{period}
+    {
+        for (auto state : rare)
+            setRare(state);
+    }
+
+    void setPeriod(std::uint32_t period) noexcept
+    {
+        _period.store(period, std::memory_order_relaxed);
+    }
+
+    std::uint32_t period() const noexcept
+    {
+        return _period.load(std::memory_order_relaxed);
+    }
+
+    /// Not synchronized with the recording, configure before use
+    void setRare(std::size_t state, bool rare = true)
+    {
+        if (state >= _rare.size())
+            _rare.resize(state + 1);
+        _rare[state] = rare;
+    }
+
+    bool isRare(std::size_t state) const noexcept
+    {
+        return state < _rare.size() && _rare[state];
+    }
+
+    /// Next event should be recorded, `skipped` - events dropped by the machine since its last recorded one
+    bool sample(std::uint64_t &skipped) const noexcept
+    {
+        if (++skipped < _period.load(std::memory_order_relaxed)) [[likely]]
+            return false;
+        skipped = 0;
+        return true;
+    }
+
+private:
+    std::atomic<std::uint32_t> _period;
+    std::vector<bool>          _rare;
+};
+
+/**
+ * Table context mixin recording transitions and events of the machine into the `Sink` (any class with
+ * `void record(vfsm::TraceRecord const&)`) from the Fsm onStateChange()/onEvent() hooks. Events are numbered by the
+ * position in the `Events` list, others get `sizeof...(Events)`.
+ *
+ * State span is recorded when the state is left: call flush() before the sink is closed to record the current one.
+ *
+ * When the context defines its own hooks, call the TracingContext ones from them.
+ *
+ * Sample:
+ * ```
+ * struct Context : vfsm::TracingContext<vfsm::ChromeTrace, Ev::Connect, Ev::Close> { ... };
+ *
+ * std::ofstream file{"trace.json"};
+ * vfsm::ChromeTrace trace{file, Fsm::state_names, vfsm::type_names<Ev::Connect, Ev::Close>};
+ * Fsm sm{Context{trace, 1}, Idle{}};
+ * ...
+ * sm.context().flush();
+ * ```
+ */
+template <class Sink, class... Events>
+class TracingContext
+{
+public:
+    TracingContext(Sink &sink, std::uint32_t machine)
+        : _sink{&sink},
+          _machine{machine},
+          _entered{now()}
+    {}
+
+    /// Sampled recording, see vfsm::TraceSampler
+    TracingContext(Sink &sink, std::uint32_t machine, TraceSampler &sampler)
+        : TracingContext(sink, machine)
+    {
+        _sampler = &sampler;
+    }
+
+    std::uint32_t machine() const noexcept
+    {
+        return _machine;
+    }
+
+    /**
+     * Record the span of the current state up to now, it continues from now on
+     */
+    void flush()
+    {
+        if (_pending) {
+            _pending = false;
+            _entered = s_unknown;
+        }
+        recordTransition(_state, _state, now());
+    }
+
+    //
+    // Fsm hooks
+    //
+    void onStart(std::size_t state)
+    {
+        _state = std::uint32_t(state);
+        _entered = now();
+        _pending = false;
+    }
+
+    void onStateChange(std::size_t from, std::size_t to)
+    {
+        _state = std::uint32_t(to);
+        if (_sampler && !_sampler->isRare(from) && !_sampler->isRare(to)) {
+            // Decided by the event, the clock is not read for the dropped ones
+            _pending = true;
+            _from = std::uint32_t(from);
+            return;
+        }
+        recordTransition(from, to, now());
+    }
+
+    template <class Event>
+    void onEvent(std::size_t state, bool handled)
+    {
+        if (_sampler && !_sampler->sample(_skipped)) [[likely]] {
+            if (_pending) {
+                _pending = false;
+                _entered = s_unknown;
+            }
+            return;
+        }
+
+        auto const time = now();
+        if (_pending) {
+            _pending = false;
+            recordTransition(_from, state, time);
+        }
+        constexpr auto event = std::uint32_t(detail::index_of<Event, Events...>());
+        _sink->record({TraceRecord::Event, handled, _machine, std::uint32_t(state), std::uint32_t(state), event,
+                       _entered, time});
+    }
+
+private:
+    static constexpr std::int64_t s_unknown = -1;
+
+    static std::int64_t now() noexcept
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    void recordTransition(std::size_t from, std::size_t to, std::int64_t time)
+    {
+        _sink->record({TraceRecord::Transition, true, _machine, std::uint32_t(from), std::uint32_t(to), 0,
+                       _entered, time});
+        _entered = time;
+    }
+
+private:
+    Sink          *_sink;
+    TraceSampler  *_sampler = nullptr;
+    std::uint32_t  _machine;
+    // Source state of the transition waiting for the sampling decision
+    std::uint32_t  _from = 0;
+    std::uint32_t  _state = 0;
+    bool           _pending = false;
+    // Events dropped since the last recorded one, the first one is always recorded
+    std::uint64_t  _skipped = std::numeric_limits<std::uint32_t>::max();
+    // Entry time of the current state
+    std::int64_t   _entered;
+};
+
+/**
+ * Recorder sink streaming the Chrome Trace Event JSON (chrome://tracing, ui.perfetto.dev) into the output stream
+ * record by record, nothing is buffered besides the stream itself. Every machine is a track (`tid`), state residency
+ * is a span, processed event is an instant. The array is closed on destruction, though the viewers accept the
+ * truncated one as well.
+ *
+ * Not thread-safe: use one sink per thread or serialize the recording.
+ */
+class ChromeTrace
+{
+public:
+    /// Missed state and event names are replaced by the indexes
+    explicit ChromeTrace(std::ostream &out,
+                         std::span<std::string_view const> stateNames = {},
+                         std::span<std::string_view const> eventNames = {})
+        : _out{&out},
+          _stateNames{stateNames},
+          _eventNames{eventNames},
+          _origin{std::chrono::duration_cast<std::chrono::nanoseconds>(
+              std::chrono::steady_clock::now().time_since_epoch()).count()}
+    {
+        *_out << "{\"traceEvents\":[";
+    }
+
+    ChromeTrace(ChromeTrace const&) = delete;
+    ChromeTrace& operator=(ChromeTrace const&) = delete;
+
+    ~ChromeTrace()
+    {
+        *_out << "\n]}\n";
+        _out->flush();
+    }
+
+    /// Name of the machine track in the viewer
+    void nameTrack(std::uint32_t machine, std::string_view name)
+    {
+        begin();
+        *_out << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << machine
+              << ",\"args\":{\"name\":\"";
+        writeString(name);
+        *_out << "\"}}";
+    }
+
+    void record(TraceRecord const& rec)
+    {
+        begin();
+        if (rec.kind == TraceRecord::Transition && rec.since < 0) {
+            // Entry time is not known: the transition itself
+            *_out << "{\"name\":\"";
+            writeName(_stateNames, rec.to);
+            *_out << "\",\"cat\":\"state\",\"ph\":\"i\",\"s\":\"t\",\"ts\":";
+            writeMicros(rec.time - _origin);
+            *_out << ",\"args\":{\"from\":\"";
+            writeName(_stateNames, rec.from);
+            *_out << "\"}";
+        } else if (rec.kind == TraceRecord::Transition) {
+            *_out << "{\"name\":\"";
+            writeName(_stateNames, rec.from);
+            *_out << "\",\"cat\":\"state\",\"ph\":\"X\",\"ts\":";
+            writeMicros(rec.since - _origin);
+            *_out << ",\"dur\":";
+            writeMicros(rec.time - rec.since);
+        } else {
+            *_out << "{\"name\":\"";
+            writeName(_eventNames, rec.event);
+            *_out << "\",\"cat\":\"event\",\"ph\":\"i\",\"s\":\"t\",\"ts\":";
+            writeMicros(rec.time - _origin);
+            *_out << ",\"args\":{\"handled\":" << (rec.handled ? "true" : "false") << '}';
+        }
+        *_out << ",\"pid\":1,\"tid\":" << rec.machine << '}';
+        ++_count;
+    }
+
+    /// Records written
+    std::size_t size() const noexcept
+    {
+        return _count;
+    }
+
+private:
+    void begin()
+    {
+        *_out << (_first ? "\n" : ",\n");
+        _first = false;
+    }
+
+    void writeName(std::span<std::string_view const> names, std::uint32_t i)
+    {
+        if (i < names.size())
+            writeString(names[i]);
+        else
+            *_out << i;
+    }
+
+    // JSON string content: quote, backslash and control characters are escaped, plain runs are written as is
+    void writeString(std::string_view text)
+    {
+        static constexpr char hex[] = "0123456789abcdef";
+        std::size_t plain = 0;
+        for (std::size_t i = 0; i < text.size(); ++i) {
+            auto const c = static_cast<unsigned char>(text[i]);
+            if (c >= 0x20 && c != '"' && c != '\\')
+                continue;
+            _out->write(text.data() + plain, std::streamsize(i - plain));
+            plain = i + 1;
+            switch (c) {
+                case '"':
+                    *_out << "\\\"";
+                    break;
+                case '\\':
+                    *_out << "\\\\";
+                    break;
+                case '\n':
+                    *_out << "\\n";
+                    break;
+                case '\r':
+                    *_out << "\\r";
+                    break;
+                case '\t':
+                    *_out << "\\t";
+                    break;
+                default:
+                    char const escaped[] = {'\\', 'u', '0', '0', hex[c >> 4], hex[c & 0xf]};
+                    _out->write(escaped, sizeof(escaped));
+            }
+        }
+        _out->write(text.data() + plain, std::streamsize(text.size() - plain));
+    }
+
+    // Trace Event timestamps are microseconds
+    void writeMicros(std::int64_t ns)
+    {
+        char buf[32];
+        auto *p = buf;
+        if (ns < 0) {
+            *p++ = '-';
+            ns = -ns;
+        }
+        p = std::to_chars(p, buf + sizeof(buf), ns / 1000).ptr;
+        auto const frac = ns % 1000;
+        *p++ = '.';
+        *p++ = char('0' + frac / 100);
+        *p++ = char('0' + frac / 10 % 10);
+        *p++ = char('0' + frac % 10);
+        _out->write(buf, p - buf);
+    }
+
+private:
+    std::ostream                      *_out;
+    std::span<std::string_view const>  _stateNames;
+    std::span<std::string_view const>  _eventNames;
+    std::int64_t                       _origin;
+    std::size_t                        _count = 0;
+    bool                               _first = true;
+};
+
+} // vfsm
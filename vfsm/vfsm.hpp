@@ -17,8 +17,42 @@
 
 #pragma once
 
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <span>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
 #include <variant>
 
+// Dispatch by plain function-pointer tables instead of std::visit for -O0 builds, where std::visit machinery is not
+// inlined. Opt-in: define it to the same value for the whole program, the machine code differs under the same names.
+#ifndef VFSM_DEBUG_DISPATCH
+#  define VFSM_DEBUG_DISPATCH 0
+#endif
+
+// Code size over speed: OnExit handlers are dispatched by the single shared table instead of being inlined into every
+// transition, see vfsm::Fsm::handleOnExitEnter(). For the flash-limited targets. Every translation unit must see the
+// same value: the Fsm members are compiled differently under the same names (ODR violation otherwise).
+#ifndef VFSM_SMALL_FOOTPRINT
+#  define VFSM_SMALL_FOOTPRINT 0
+#endif
+
+#ifndef VFSM_ALWAYS_INLINE
+#  if defined(__GNUC__) || defined(__clang__)
+#    define VFSM_ALWAYS_INLINE [[gnu::always_inline]]
+#  elif defined(_MSC_VER)
+#    define VFSM_ALWAYS_INLINE __forceinline
+#  else
+#    define VFSM_ALWAYS_INLINE
+#  endif
+#endif
+
 namespace vfsm {
 
 //
@@ -37,6 +71,370 @@ template<class... Ts> overload(Ts...) -> overload<Ts...>;
 struct OnEnter {};
 struct OnExit  {};
 
+namespace detail {
+
+template <class T, class... Ts>
+constexpr std::size_t index_of()
+{
+    constexpr bool matches[] = {std::is_same_v<T, Ts>..., false};
+    std::size_t i = 0;
+    while (i < sizeof...(Ts) && !matches[i])
+        ++i;
+    return i;
+}
+
+template <class... Ts>
+constexpr bool is_unique()
+{
+    constexpr std::size_t first[] = {index_of<Ts, Ts...>()..., 0};
+    for (std::size_t i = 0; i < sizeof...(Ts); ++i) {
+        if (first[i] != i)
+            return false;
+    }
+    return true;
+}
+
+template <class>
+struct MemberOf;
+
+template <class Class, class Type>
+struct MemberOf<Type Class::*>
+{
+    using ClassType = Class;
+    using ValueType = Type;
+};
+
+// Default bound of the vfsm::Domain
+struct Unbounded {};
+
+template <class Value>
+constexpr long long toInteger(Value value)
+{
+    if constexpr (std::is_enum_v<Value>)
+        return static_cast<long long>(static_cast<std::underlying_type_t<Value>>(value));
+    else
+        return static_cast<long long>(value);
+}
+
+template <class Result, class Fn, class Variant, std::size_t I>
+constexpr Result visitAt(Fn &fn, Variant &variant)
+{
+    return fn(*std::get_if<I>(&variant));
+}
+
+template <class Result, class Fn, class Variant, std::size_t... I>
+inline constexpr Result (*s_visitTable[])(Fn&, Variant&) = {&visitAt<Result, Fn, Variant, I>...};
+
+template <class Fn, class Variant, std::size_t... I>
+VFSM_ALWAYS_INLINE constexpr decltype(auto) visitIndexed(Fn &fn, Variant &variant, std::index_sequence<I...>)
+{
+    using Result = decltype(fn(*std::get_if<0>(&variant)));
+    return s_visitTable<Result, Fn, Variant, I...>[variant.index()](fn, variant);
+}
+
+// std::visit or the single indirect call by the table, see VFSM_DEBUG_DISPATCH. Variant must not be valueless.
+template <class Fn, class Variant>
+VFSM_ALWAYS_INLINE constexpr decltype(auto) visit(Fn &&fn, Variant &&variant)
+{
+#if VFSM_DEBUG_DISPATCH
+    using Plain = std::remove_reference_t<Variant>;
+    return visitIndexed(fn, variant, std::make_index_sequence<std::variant_size_v<std::remove_cv_t<Plain>>>{});
+#else
+    return std::visit(std::forward<Fn>(fn), std::forward<Variant>(variant));
+#endif
+}
+
+} // detail
+
+/**
+ * Result of the pure handler, see vfsm::pure()
+ */
+template <class Result>
+struct PureResult
+{
+    Result value;
+};
+
+template <>
+struct PureResult<void>
+{};
+
+/**
+ * Handler result without PureResult wrapper
+ */
+template <class Result>
+VFSM_ALWAYS_INLINE constexpr Result&& unpure(Result &&result)
+{
+    return std::forward<Result>(result);
+}
+
+template <class Result>
+VFSM_ALWAYS_INLINE constexpr Result unpure(PureResult<Result> &&result)
+{
+    return std::move(result.value);
+}
+
+VFSM_ALWAYS_INLINE constexpr void unpure(PureResult<void>)
+{}
+
+namespace detail {
+
+template <class F, class Signature = decltype(&F::operator())>
+struct Pure;
+
+template <class F, class Result, class... Args>
+struct Pure<F, Result (F::*)(Args...) const> : F
+{
+    VFSM_ALWAYS_INLINE constexpr PureResult<Result> operator()(Args... args) const
+    {
+        if constexpr (std::is_void_v<Result>) {
+            F::operator()(std::forward<Args>(args)...);
+            return {};
+        } else {
+            return {F::operator()(std::forward<Args>(args)...)};
+        }
+    }
+};
+
+template <class F, class Result, class... Args>
+struct Pure<F, Result (F::*)(Args...) const noexcept> : Pure<F, Result (F::*)(Args...) const>
+{};
+
+template <class>
+inline constexpr bool is_pure_result = false;
+
+template <class Result>
+inline constexpr bool is_pure_result<PureResult<Result>> = true;
+
+} // detail
+
+/**
+ * Declare transition handler as pure: target state depends only on the (state, event) pair, no side effects.
+ *
+ * For the events with declared enumerable value domain (see vfsm::Domain) target states of the pure handlers are
+ * evaluated at compile time for every (state, event value) pair, and the handler call is replaced by the table
+ * lookup at runtime. Handler must be non-generic lambda, evaluable in constant expressions with the
+ * default-constructed context. Table keeps only the target index, so it is used only when all the states are empty
+ * types; with any state carrying data the pure handlers are called as usual.
+ *
+ * ```
+ * [](Idle, EvTms ev) -> std::variant<SelectDrScan, Idle> { if (ev.val) return {}; return Idle{}; }
+ * // becomes
+ * vfsm::pure([](Idle, EvTms ev) -> std::variant<SelectDrScan, Idle> { if (ev.val) return {}; return Idle{}; })
+ * ```
+ */
+template <class F>
+constexpr detail::Pure<F> pure(F handler)
+{
+    return {std::move(handler)};
+}
+
+/**
+ * Enumerable event value domain: event is completely described by the single `Member` of bool, enum or integral
+ * type with values in `[Min, Max]`. Bounds are required for all but bool members, bool defaults to `[false, true]`.
+ *
+ * Declared in the event:
+ * ```
+ * struct EvTms { bool val{}; using Domain = vfsm::Domain<&EvTms::val>; };
+ * struct EvKey { Key key{}; using Domain = vfsm::Domain<&EvKey::key, Key::First, Key::Last>; };
+ * ```
+ * or for the foreign event types by the vfsm::EventDomain specialization.
+ */
+template <auto Member, auto Min = detail::Unbounded{}, auto Max = detail::Unbounded{}>
+struct Domain
+{
+    using Event = typename detail::MemberOf<decltype(Member)>::ClassType;
+    using Value = typename detail::MemberOf<decltype(Member)>::ValueType;
+
+    static_assert(std::is_same_v<Value, bool> ||
+                  (!std::is_same_v<std::remove_cv_t<decltype(Min)>, detail::Unbounded> &&
+                   !std::is_same_v<std::remove_cv_t<decltype(Max)>, detail::Unbounded>),
+                  "Domain of the non-bool member needs explicit bounds: vfsm::Domain<&Event::member, Min, Max>");
+
+private:
+    template <auto Bound>
+    static constexpr long long bound(long long unbounded)
+    {
+        if constexpr (std::is_same_v<std::remove_cv_t<decltype(Bound)>, detail::Unbounded>)
+            return unbounded;
+        else
+            return detail::toInteger(Bound);
+    }
+
+    static constexpr long long s_min = bound<Min>(0);
+    static constexpr long long s_max = bound<Max>(1);
+
+public:
+    static_assert(s_min <= s_max, "Empty event domain");
+
+    static constexpr std::size_t size = std::size_t(s_max - s_min + 1);
+
+    // Values outside of the domain give index >= size
+    static constexpr std::size_t index(Event const& event) noexcept
+    {
+        return std::size_t(detail::toInteger(event.*Member) - s_min);
+    }
+
+    static constexpr Event value(std::size_t index) noexcept
+    {
+        Event event{};
+        event.*Member = static_cast<Value>(s_min + static_cast<long long>(index));
+        return event;
+    }
+
+    // Every value of the member is inside: handlers precomputed over the domain are never called at runtime
+    static constexpr bool complete = [] {
+        using Integer = typename std::conditional_t<std::is_enum_v<Value>,
+                                                    std::underlying_type<Value>,
+                                                    std::type_identity<Value>>::type;
+        if constexpr (sizeof(Integer) < sizeof(long long)) {
+            return s_min == detail::toInteger(std::numeric_limits<Integer>::min()) &&
+                   s_max == detail::toInteger(std::numeric_limits<Integer>::max());
+        } else {
+            return false;
+        }
+    }();
+};
+
+template <class Event>
+struct EventDomain
+{};
+
+template <class Event>
+    requires requires { typename Event::Domain; }
+struct EventDomain<Event>
+{
+    using type = typename Event::Domain;
+};
+
+namespace detail {
+
+template <class T>
+constexpr std::string_view signature() noexcept
+{
+#if defined(_MSC_VER) && !defined(__clang__)
+    return __FUNCSIG__;
+#else
+    return __PRETTY_FUNCTION__;
+#endif
+}
+
+// Type name position in the signature, probed on the known type
+inline constexpr std::size_t s_namePrefix = signature<int>().find("int");
+inline constexpr std::size_t s_nameSuffix = signature<int>().size() - s_namePrefix - 3;
+
+template <class T>
+constexpr auto storeTypeName() noexcept
+{
+    constexpr auto signature = detail::signature<T>();
+    constexpr auto raw = signature.substr(s_namePrefix, signature.size() - s_namePrefix - s_nameSuffix);
+    // MSVC spells the class key
+    constexpr auto name = raw.starts_with("struct ") ? raw.substr(7) : raw.starts_with("class ") ? raw.substr(6) : raw;
+
+    std::array<char, name.size() + 1> result{};
+    std::copy(name.begin(), name.end(), result.begin());
+    return result;
+}
+
+// Trimmed copy: only the name itself gets into the read-only data
+template <class T>
+inline constexpr auto s_typeName = storeTypeName<T>();
+
+} // detail
+
+/**
+ * Qualified name of the type, extracted from the compiler function signature at compile time
+ *
+ * Sample:
+ * ```
+ * static_assert(vfsm::type_name<Jtag::ShiftDr>() == "Jtag::ShiftDr");
+ * ```
+ */
+template <class T>
+constexpr std::string_view type_name() noexcept
+{
+    return {detail::s_typeName<T>.data(), detail::s_typeName<T>.size() - 1};
+}
+
+/**
+ * Names table of the types, indexed by the position in the list. Fsm::state_names is the table of the states; ids
+ * written by the tracer or the counters are resolved to names with it.
+ *
+ * Sample:
+ * ```
+ * constexpr auto& eventNames = vfsm::type_names<Ev::Connect, Ev::Ack, Ev::Close>;
+ * ```
+ */
+template <class... Ts>
+inline constexpr std::array<std::string_view, sizeof...(Ts)> type_names = {type_name<Ts>()...};
+
+/**
+ * Table context split into the immutable part shared between all machine instances and the small per-instance
+ * mutable part (flyweight).
+ *
+ * `Shared` provides transition table as `operator()(Local&) const`, so handlers receive both parts: shared
+ * configuration via captured `this` and instance data via captured reference to the `Local`. Machine instance keeps
+ * only the pointer to the `Shared` and the `Local` data. `Shared` object must outlive all machines referencing it.
+ *
+ * Sample:
+ * ```
+ * struct Session { int retries = 0; };
+ *
+ * struct Protocol {
+ *   constexpr auto operator()(Session &s) const {
+ *     return vfsm::overload{
+ *       [this,&s](Wait, EvTimeout) -> std::variant<Wait, Fail> { if (++s.retries == maxRetries) return Fail{}; return {}; },
+ *     };
+ *   }
+ *   int maxRetries = 3;
+ *   // ... other heavy configuration ...
+ * };
+ *
+ * using ProtocolFsm = vfsm::Fsm<vfsm::SharedContext<Protocol, Session>, Wait, Fail>;
+ *
+ * static const Protocol protocol{};
+ * ProtocolFsm sm{{protocol, Session{}}, Wait{}};
+ * ```
+ */
+template <class Shared, class Local>
+    requires (requires (Shared const& shared, Local& local) { shared(local); })
+class SharedContext
+{
+public:
+    /// `shared` is referenced, it must outlive the context
+    constexpr SharedContext(Shared const& shared, Local &&local = {})
+        : _shared{&shared},
+          _local{std::move(local)}
+    {}
+
+    // Temporary would dangle right after the construction
+    SharedContext(Shared const&&, Local && = {}) = delete;
+
+    constexpr auto operator()()
+    {
+        return (*_shared)(_local);
+    }
+
+    constexpr Shared const& shared() const noexcept
+    {
+        return *_shared;
+    }
+
+    constexpr Local const& local() const noexcept
+    {
+        return _local;
+    }
+
+    constexpr Local& local() noexcept
+    {
+        return _local;
+    }
+
+private:
+    Shared const *_shared;
+    Local         _local;
+};
+
 /**
  * Simple Finite State Machine implementation using C++20 features and std::variant
  *
@@ -86,43 +484,250 @@ struct OnExit  {};
  *
  * ```
  *
+ * Optional hooks of the TableContext, called when defined:
+ * ```
+ * // Between OnExit of the `from` and OnEnter of the `to` state
+ * void onStateChange(std::size_t from, std::size_t to);
+ * // After every processEvent() (Event is void for poll()) with the resulting state
+ * template <class Event> void onEvent(std::size_t state, bool handled);
+ * // After the initial state OnEnter of the constructor and reset()
+ * void onStart(std::size_t state);
+ * ```
+ *
  */
 template <class TableContext, class... States>
     requires (requires (TableContext t) { t(); })
 class Fsm
 {
+    static_assert(detail::is_unique<States...>(), "State listed twice, see vfsm::ReachableFsm to deduplicate");
+
 public:
     ~Fsm() = default;
 
     using StateVariant = std::variant<States...>;
 
+    static constexpr std::size_t state_count = sizeof...(States);
+
+    /// Names of the states by index, see vfsm::type_name()
+    static constexpr auto& state_names = type_names<States...>;
+
     constexpr Fsm(TableContext &&table, StateVariant &&initialState)
         : _context {std::move(table)},
           _state {std::move(initialState)}
     {
-        // Handle initalState onEnter here
-        std::visit([this](auto&& s) {
-            if constexpr (requires { _context()(s, s, OnEnter{}); }) {
-                _context()(s, s, OnEnter{});
-            } else if constexpr (requires { _context()(s, OnEnter{}); }) {
-                _context()(s, OnEnter{});
+        handleInitialOnEnter();
+    }
+
+    /**
+     * Reinitialize machine in-place with the given context and initial state, initial state OnEnter is called.
+     *
+     * Current state OnExit is not called, same as assignment of the newly constructed machine.
+     */
+    constexpr void reset(TableContext &&table, StateVariant &&initialState)
+    {
+        _context = std::move(table);
+        _state = std::move(initialState);
+        handleInitialOnEnter();
+    }
+
+    constexpr void reset(StateVariant &&initialState)
+        requires std::is_default_constructible_v<TableContext>
+    {
+        reset(TableContext{}, std::move(initialState));
+    }
+
+    /**
+     * Same as reset(), but current state OnExit is called first with the initial state as a target one.
+     *
+     * Unlike the transition by the event, OnExit/OnEnter are called even if current and initial states are the same.
+     */
+    constexpr void reset_with_exit(TableContext &&table, StateVariant &&initialState)
+    {
+        std::visit([this](auto&& currentState, auto&& newState) {
+            if constexpr (requires { _context()(currentState, newState, OnExit{}); }) {
+                _context()(currentState, newState, OnExit{});
+            } else if constexpr (requires { _context()(currentState, OnExit{}); }) {
+                _context()(currentState, OnExit{});
             }
-        }, _state);
+        }, _state, initialState);
+        reset(std::move(table), std::move(initialState));
+    }
+
+    constexpr void reset_with_exit(StateVariant &&initialState)
+        requires std::is_default_constructible_v<TableContext>
+    {
+        reset_with_exit(TableContext{}, std::move(initialState));
+    }
+
+    /**
+     * Bulk reset() of the contiguous pool of machines to the default context and the given initial state.
+     *
+     * When machine is trivially copyable, pool is filled from the single prototype by raw memory copy (plain memset
+     * for all-zero prototype), initial OnEnter and onStart() are called per machine only if the table defines them.
+     * Hooks fire the same way as by reset().
+     */
+    static constexpr void reset_all(std::span<Fsm> pool, StateVariant const& initialState)
+        requires std::is_default_constructible_v<TableContext>
+    {
+        if (pool.empty())
+            return;
+
+        if constexpr (std::is_trivially_copyable_v<Fsm>) {
+            if (!std::is_constant_evaluated())
+                return fillPool(pool, initialState);
+        }
+        for (auto &sm : pool)
+            sm.reset(StateVariant{initialState});
+    }
+
+    /**
+     * Independent copy of the machine, e.g. for speculative evaluation of the event sequence.
+     *
+     * Trivially copyable machine (all states and context) is copied as raw bytes, without variant and context copy
+     * constructors.
+     */
+    constexpr Fsm fork() const
+        requires std::is_copy_constructible_v<TableContext>
+    {
+        if constexpr (std::is_trivially_copyable_v<Fsm>) {
+            if (!std::is_constant_evaluated())
+                return std::bit_cast<Fsm>(*this);
+        }
+        return *this;
+    }
+
+    VFSM_ALWAYS_INLINE constexpr bool poll()
+    {
+        if constexpr (requires { _context.template onEvent<void>(std::size_t{}, true); }) {
+            auto const handled = pollState();
+            _context.template onEvent<void>(_state.index(), handled);
+            return handled;
+        } else {
+            return pollState();
+        }
+    }
+
+    template <typename Event>
+    VFSM_ALWAYS_INLINE constexpr bool processEvent(Event &&event)
+    {
+        using EventType = std::remove_cvref_t<Event>;
+        if constexpr (requires { _context.template onEvent<EventType>(std::size_t{}, true); }) {
+            auto const handled = dispatchEvent(std::forward<Event>(event));
+            _context.template onEvent<EventType>(_state.index(), handled);
+            return handled;
+        } else {
+            return dispatchEvent(std::forward<Event>(event));
+        }
+    }
+
+    /**
+     * Zero-based position of the current state in the `States...` list
+     */
+    VFSM_ALWAYS_INLINE constexpr std::size_t state_index() const noexcept
+    {
+        return _state.index();
+    }
+
+    constexpr std::string_view state_name() const noexcept
+    {
+        return state_names[_state.index()];
     }
 
-    constexpr bool poll()
+    /**
+     * Zero-based position of the `State` in the `States...` list
+     */
+    template <class State>
+        requires (std::is_same_v<State, States> || ...)
+    static constexpr std::size_t index_of() noexcept
     {
-        return std::visit([this](auto&& state) -> bool {
-            if constexpr (requires { _state = _context()(state); }) {
-                auto newState = _context()(state);
-                handleOnExitEnter(newState);
-                _state = std::move(newState);
+        return detail::index_of<State, States...>();
+    }
+
+    /**
+     * All handlers of the enumerable `Event` are pure (see vfsm::pure) and precomputed
+     */
+    template <class Event>
+        requires requires { typename EventDomain<Event>::type; }
+    static constexpr bool is_pure() noexcept
+    {
+        return std::none_of(s_transitions<Event>.begin(), s_transitions<Event>.end(),
+                            [](auto target) { return target == s_dynamic; });
+    }
+
+    /**
+     * Precomputed target state index of the pure transition without the machine instance. Returns `state` for the
+     * unhandled event and for the event value outside of the domain, `state_count` if the transition is not pure.
+     */
+    template <class Event>
+        requires requires { typename EventDomain<Event>::type; }
+    static constexpr std::size_t pure_target(std::size_t state, Event const& event) noexcept
+    {
+        using Domain = typename EventDomain<Event>::type;
+        auto const value = Domain::index(event);
+        if (value >= Domain::size)
+            return state;
+        auto const target = s_transitions<Event>[state * Domain::size + value];
+        if (target == s_unhandled)
+            return state;
+        return target == s_dynamic ? sizeof...(States) : target;
+    }
+
+    /**
+     * Count of the equivalence classes of the states over the TableContext::Minimize events. Diagnostic only: the
+     * dispatch keeps the real states, see dispatch_row_count().
+     */
+    static constexpr std::size_t minimal_state_count() noexcept
+    {
+        if constexpr (requires { typename TableContext::Minimize; })
+            return s_minimal.count;
+        else
+            return sizeof...(States);
+    }
+
+    /**
+     * Rows of the TableContext::Minimize events dispatch table: states with the identical targets share the row
+     */
+    static constexpr std::size_t dispatch_row_count() noexcept
+    {
+        if constexpr (requires { typename TableContext::Minimize; })
+            return s_minimal.rows;
+        else
+            return sizeof...(States);
+    }
+
+    constexpr auto visit(auto&& fn) const
+    {
+        return detail::visit(fn, _state);
+    }
+
+    constexpr auto visit(auto&& fn)
+    {
+        return detail::visit(fn, _state);
+    }
+
+    constexpr auto const& context() const
+    {
+        return _context;
+    }
+
+    constexpr auto& context()
+    {
+        return _context;
+    }
+
+private:
+    struct NoEnter {};
+
+    constexpr bool pollState()
+    {
+        return detail::visit([this](auto&& state) -> bool {
+            // Variant result first: the full StateVariant is assignable to the state as well
+            if constexpr (requires { std::visit([](auto&&){}, unpure(_context()(state))); }) {
+                detail::visit([this](auto&& newState) { transit(newState); }, unpure(_context()(state)));
                 return true;
-            } else if constexpr (requires { std::visit([](auto&&){}, _context()(state)); }) {
-                std::visit([this](auto&& newState) {
-                    handleOnExitEnter(newState);
-                    _state = std::move(newState);
-                }, _context()(state));
+            } else if constexpr (requires { _state = unpure(_context()(state)); }) {
+                auto newState = unpure(_context()(state));
+                transit(newState);
                 return true;
             } else if constexpr (requires { _context()(state); }) {
                 _context()(state);
@@ -134,21 +739,39 @@ public:
     }
 
     template <typename Event>
-    constexpr bool processEvent(Event &&event)
+    constexpr bool dispatchEvent(Event &&event)
     {
-        return std::visit([this,&event](auto&& state) -> bool {
-            if constexpr (requires { _state = _context()(state, event); }) {
-                auto newState = _context()(state, std::forward<Event>(event));
-                handleOnExitEnter(newState);
-                _state = std::move(newState);
-                return true;
-            } else if constexpr (requires { std::visit([](auto&&){},_context()(state, event)); }) {
-                // iterate over resulting variants
-                std::visit([this](auto&& newState) {
-                    handleOnExitEnter(newState);
-                    _state = std::move(newState);
-                }, _context()(state, std::forward<Event>(event)));
+        using EventType = std::remove_cvref_t<Event>;
+
+        // Precomputed transitions of the pure handlers for the enumerable events
+        if constexpr (requires { typename EventDomain<EventType>::type; }) {
+            using Domain = typename EventDomain<EventType>::type;
+            auto const value = Domain::index(event);
+            if (value < Domain::size) {
+                auto const target = pureTransition<EventType>(value);
+                if (target < sizeof...(States)) {
+                    if (target != _state.index())
+                        enterState(target);
+                    return true;
+                } else if (target == s_unhandled) {
+                    return false;
+                }
+            }
+        }
 
+        return detail::visit([this,&event](auto&& state) -> bool {
+            if constexpr (isPrecomputed<std::remove_cvref_t<decltype(state)>, EventType>()) {
+                // Resolved by the table above, handler is not instantiated
+                return false;
+            } else if constexpr (requires { std::visit([](auto&&){}, unpure(_context()(state, event))); }) {
+                // iterate over resulting variants, the full StateVariant included
+                detail::visit([this](auto&& newState) { transit(newState); },
+                              unpure(_context()(state, std::forward<Event>(event))));
+
+                return true;
+            } else if constexpr (requires { _state = unpure(_context()(state, event)); }) {
+                auto newState = unpure(_context()(state, std::forward<Event>(event)));
+                transit(newState);
                 return true;
             } else if constexpr (requires { _context()(state, event); }) {
                 _context()(state, std::forward<Event>(event));
@@ -159,33 +782,425 @@ public:
         }, _state);
     }
 
-    constexpr auto visit(auto&& fn) const
+    //
+    // Precomputed transitions
+    //
+    using TransitionIndex = std::conditional_t<(sizeof...(States) < 0xfe), std::uint8_t, std::uint16_t>;
+
+    static constexpr TransitionIndex s_dynamic   = TransitionIndex(~TransitionIndex(0));
+    static constexpr TransitionIndex s_unhandled = TransitionIndex(s_dynamic - 1);
+
+    template <class State, class Event, std::size_t Value>
+    static constexpr TransitionIndex evalPureTarget()
     {
-        return std::visit(fn, _state);
+        using Domain = typename EventDomain<Event>::type;
+        TableContext ctx{};
+        State state{};
+        using Result = decltype(unpure(ctx()(state, Domain::value(Value))));
+        if constexpr (std::is_void_v<Result>) {
+            ctx()(state, Domain::value(Value));
+            return TransitionIndex(index_of<State>());
+        } else {
+            auto next = unpure(ctx()(state, Domain::value(Value)));
+            if constexpr (requires { std::visit([](auto&&){}, next); }) {
+                return std::visit([](auto&& s) {
+                    return TransitionIndex(index_of<std::remove_cvref_t<decltype(s)>>());
+                }, next);
+            } else {
+                return TransitionIndex(index_of<Result>());
+            }
+        }
     }
 
-    constexpr auto visit(auto&& fn)
+    template <class State, class Event, std::size_t Value>
+    static constexpr TransitionIndex pureTarget()
     {
-        return std::visit(fn, _state);
+        if constexpr (!requires (TableContext ctx, State& s, Event& e) { ctx()(s, e); }) {
+            return s_unhandled;
+        } else if constexpr (!(std::is_empty_v<States> && ...) ||
+                             !std::is_default_constructible_v<TableContext> ||
+                             !detail::is_pure_result<decltype(std::declval<TableContext&>()()(
+                                 std::declval<State&>(), std::declval<Event&>()))>) {
+            return s_dynamic;
+        } else if constexpr (requires {
+                                 typename std::integral_constant<TransitionIndex,
+                                                                 evalPureTarget<State, Event, Value>()>;
+                             }) {
+            // Handler is evaluable at compile time
+            return evalPureTarget<State, Event, Value>();
+        } else {
+            return s_dynamic;
+        }
     }
 
-    auto const& context() const
+    template <class State, class Event, class Table, std::size_t... V>
+    static constexpr void buildStateTransitions(Table &table, std::index_sequence<V...>)
     {
-        return _context;
+        constexpr auto row = index_of<State>() * sizeof...(V);
+        ((table[row + V] = pureTarget<State, Event, V>()), ...);
     }
 
-    auto& context()
+    template <class Event>
+    static constexpr auto buildTransitions()
     {
-        return _context;
+        using Domain = typename EventDomain<Event>::type;
+        std::array<TransitionIndex, sizeof...(States) * Domain::size> table{};
+        (buildStateTransitions<States, Event>(table, std::make_index_sequence<Domain::size>{}), ...);
+        return table;
+    }
+
+    // [state index * domain size + event value] -> target state index | s_dynamic | s_unhandled
+    template <class Event>
+    static constexpr auto s_transitions = buildTransitions<Event>();
+
+    // No dynamic transitions of the State over the complete domain of the Event
+    template <class State, class Event>
+    static constexpr bool isPrecomputed()
+    {
+        if constexpr (requires { typename EventDomain<Event>::type; }) {
+            using Domain = typename EventDomain<Event>::type;
+            if constexpr (requires { requires Domain::complete; }) {
+                auto const row = s_transitions<Event>.begin() + index_of<State>() * Domain::size;
+                return std::none_of(row, row + Domain::size, [](auto target) { return target == s_dynamic; });
+            }
+        }
+        return false;
+    }
+
+    //
+    // Equivalent states over the TableContext::Minimize events, they share the dispatch table rows
+    //
+    template <class State, class Other>
+    static constexpr bool handlesPair()
+    {
+        return requires (TableContext &ctx, State &s, Other &o) { ctx()(s, o, OnEnter{}); } ||
+               requires (TableContext &ctx, State &s, Other &o) { ctx()(s, o, OnExit{}); };
+    }
+
+    // Own actions: poll, OnEnter/OnExit handlers
+    template <class State>
+    static constexpr bool hasActions()
+    {
+        return requires (TableContext &ctx, State &s) { ctx()(s); } ||
+               requires (TableContext &ctx, State &s) { ctx()(s, OnEnter{}); } ||
+               requires (TableContext &ctx, State &s) { ctx()(s, OnExit{}); } ||
+               (handlesPair<State, States>() || ...);
+    }
+
+    // Which states are handled as previous/next by the State OnEnter/OnExit
+    template <class State>
+    static constexpr std::array<bool, sizeof...(States)> counterparts()
+    {
+        return {handlesPair<State, States>()...};
+    }
+
+    struct Minimal
+    {
+        std::array<TransitionIndex, sizeof...(States)> classOf{};
+        std::array<TransitionIndex, sizeof...(States)> rowOf{};
+        std::array<TransitionIndex, sizeof...(States)> rowState{}; // first state of the row
+        std::size_t count = 0;
+        std::size_t rows = 0;
+    };
+
+    template <class... Events>
+    static constexpr Minimal minimize(std::tuple<Events...>*)
+    {
+        constexpr std::size_t N = sizeof...(States);
+        constexpr std::size_t S = (std::size_t(0) + ... + EventDomain<Events>::type::size);
+
+        // Combined transitions over all the event values
+        std::array<std::array<TransitionIndex, S>, N> delta{};
+        std::size_t offset = 0;
+        ([&] {
+            using Domain = typename EventDomain<Events>::type;
+            for (std::size_t q = 0; q < N; ++q) {
+                for (std::size_t v = 0; v < Domain::size; ++v)
+                    delta[q][offset + v] = s_transitions<Events>[q * Domain::size + v];
+            }
+            offset += Domain::size;
+        }(), ...);
+
+        // States with actions or non-pure handlers are never equivalent
+        constexpr bool actions[] = {hasActions<States>()..., false};
+        std::array<bool, N> mergeable{};
+        for (std::size_t q = 0; q < N; ++q) {
+            mergeable[q] = !actions[q] &&
+                           std::none_of(delta[q].begin(), delta[q].end(), [](auto t) { return t == s_dynamic; });
+        }
+
+        // Initial partition: same handled events and same role in the other states OnEnter/OnExit handlers
+        constexpr std::array<std::array<bool, N>, N> counterpart = {counterparts<States>()...};
+        auto const similar = [&](std::size_t a, std::size_t b) {
+            for (std::size_t c = 0; c < S; ++c) {
+                if ((delta[a][c] == s_unhandled) != (delta[b][c] == s_unhandled))
+                    return false;
+            }
+            for (std::size_t q = 0; q < N; ++q) {
+                if (counterpart[q][a] != counterpart[q][b])
+                    return false;
+            }
+            return true;
+        };
+
+        std::array<std::size_t, N> block{};
+        std::size_t blocks = 0;
+        for (std::size_t q = 0; q < N; ++q)
+            block[q] = N;
+        for (std::size_t q = 0; q < N; ++q) {
+            if (block[q] != N)
+                continue;
+            block[q] = blocks;
+            for (std::size_t r = q + 1; mergeable[q] && r < N; ++r) {
+                if (block[r] == N && mergeable[r] && similar(q, r))
+                    block[r] = blocks;
+            }
+            ++blocks;
+        }
+
+        // Hopcroft refinement by the (splitter block, symbol) worklist
+        std::array<std::array<bool, S>, N> pending{};
+        std::array<std::pair<std::size_t, std::size_t>, N * S> work{};
+        std::size_t top = 0;
+        auto const push = [&](std::size_t b, std::size_t c) {
+            pending[b][c] = true;
+            work[top++] = {b, c};
+        };
+        for (std::size_t b = 0; b < blocks; ++b) {
+            for (std::size_t c = 0; c < S; ++c)
+                push(b, c);
+        }
+
+        while (top) {
+            auto const [splitter, c] = work[--top];
+            pending[splitter][c] = false;
+
+            std::array<bool, N> into{};
+            for (std::size_t q = 0; q < N; ++q)
+                into[q] = delta[q][c] < N && block[delta[q][c]] == splitter;
+
+            for (std::size_t y = 0, current = blocks; y < current; ++y) {
+                std::size_t in = 0, size = 0;
+                for (std::size_t q = 0; q < N; ++q) {
+                    if (block[q] == y) {
+                        ++size;
+                        in += into[q];
+                    }
+                }
+                if (in == 0 || in == size)
+                    continue;
+
+                auto const z = blocks++;
+                for (std::size_t q = 0; q < N; ++q) {
+                    if (block[q] == y && into[q])
+                        block[q] = z;
+                }
+                for (std::size_t d = 0; d < S; ++d) {
+                    if (pending[y][d])
+                        push(z, d);
+                    else
+                        push(in < size - in ? z : y, d);
+                }
+            }
+        }
+
+        // Classes are numbered by the first member
+        Minimal result{};
+        std::array<std::size_t, N> numbered{};
+        for (std::size_t q = 0; q < N; ++q)
+            numbered[q] = N;
+        for (std::size_t q = 0; q < N; ++q) {
+            if (numbered[block[q]] == N)
+                numbered[block[q]] = result.count++;
+            result.classOf[q] = TransitionIndex(numbered[block[q]]);
+        }
+
+        // States are never merged: the table keeps the real targets, identical rows are shared
+        for (std::size_t q = 0; q < N; ++q) {
+            std::size_t row = 0;
+            while (row < result.rows && delta[result.rowState[row]] != delta[q])
+                ++row;
+            if (row == result.rows)
+                result.rowState[result.rows++] = TransitionIndex(q);
+            result.rowOf[q] = TransitionIndex(row);
+        }
+        return result;
+    }
+
+    static constexpr Minimal buildMinimal()
+    {
+        if constexpr (requires { typename TableContext::Minimize; })
+            return minimize(static_cast<typename TableContext::Minimize*>(nullptr));
+        else
+            return {};
+    }
+
+    static constexpr Minimal s_minimal = buildMinimal();
+
+    template <class Event>
+    static constexpr bool isMinimized()
+    {
+        return []<class... Events>(std::tuple<Events...>*) {
+            return (std::is_same_v<Event, Events> || ...);
+        }(static_cast<typename TableContext::Minimize*>(nullptr));
+    }
+
+    // [row * domain size + event value] -> target state | s_dynamic | s_unhandled
+    template <class Event>
+    static constexpr auto buildMinimalTransitions()
+    {
+        using Domain = typename EventDomain<Event>::type;
+        std::array<TransitionIndex, s_minimal.rows * Domain::size> table{};
+        for (std::size_t r = 0; r < s_minimal.rows; ++r) {
+            for (std::size_t v = 0; v < Domain::size; ++v)
+                table[r * Domain::size + v] = s_transitions<Event>[s_minimal.rowState[r] * Domain::size + v];
+        }
+        return table;
+    }
+
+    template <class Event>
+    static constexpr auto s_minimalTransitions = buildMinimalTransitions<Event>();
+
+    template <class Event>
+    VFSM_ALWAYS_INLINE constexpr TransitionIndex pureTransition(std::size_t value) const
+    {
+        using Domain = typename EventDomain<Event>::type;
+        if constexpr (requires { typename TableContext::Minimize; }) {
+            // Row indirection only pays when some rows are shared
+            if constexpr (isMinimized<Event>() && s_minimal.rows < sizeof...(States))
+                return s_minimalTransitions<Event>[s_minimal.rowOf[_state.index()] * Domain::size + value];
+        }
+        return s_transitions<Event>[_state.index() * Domain::size + value];
+    }
+
+    template <std::size_t I>
+    static constexpr void enterStateAt(Fsm &sm)
+    {
+        std::variant_alternative_t<I, StateVariant> newState{};
+        sm.handleOnExitEnter(newState);
+        sm._state.template emplace<I>();
+    }
+
+    template <std::size_t... I>
+    static constexpr void (*s_enterState[])(Fsm&) = {&enterStateAt<I>...};
+
+    VFSM_ALWAYS_INLINE constexpr void enterState(std::size_t index)
+    {
+        [&]<std::size_t... I>(std::index_sequence<I...>) {
+            s_enterState<I...>[index](*this);
+        }(std::index_sequence_for<States...>{});
+    }
+
+    // Raw memory fill of the trivially copyable pool, see reset_all()
+    static void fillPool(std::span<Fsm> pool, StateVariant const& initialState)
+    {
+        Fsm const proto{NoEnter{}, TableContext{}, StateVariant{initialState}};
+
+        unsigned char raw[sizeof(Fsm)];
+        std::memcpy(raw, &proto, sizeof(Fsm));
+
+        auto dst = reinterpret_cast<unsigned char*>(pool.data());
+        if (std::all_of(std::begin(raw), std::end(raw), [](unsigned char b) { return b == 0; })) {
+            std::memset(dst, 0, pool.size_bytes());
+        } else {
+            // Fill by doubling copies
+            std::memcpy(dst, raw, sizeof(Fsm));
+            for (std::size_t filled = sizeof(Fsm); filled < pool.size_bytes(); filled *= 2) {
+                std::memcpy(dst + filled, dst, std::min(filled, pool.size_bytes() - filled));
+            }
+        }
+
+        auto const hasOnEnter = std::visit([](auto&& s) {
+            using S = std::remove_cvref_t<decltype(s)>;
+            return requires (TableContext c, S st) { c()(st, st, OnEnter{}); } ||
+                   requires (TableContext c, S st) { c()(st, OnEnter{}); };
+        }, initialState);
+        constexpr bool hasOnStart = requires (TableContext c) { c.onStart(std::size_t{}); };
+
+        if (hasOnEnter || hasOnStart) {
+            for (auto &sm : pool)
+                sm.handleInitialOnEnter();
+        }
+    }
+
+    constexpr Fsm(NoEnter, TableContext &&table, StateVariant &&initialState)
+        : _context {std::move(table)},
+          _state {std::move(initialState)}
+    {}
+
+    constexpr void handleInitialOnEnter()
+    {
+        // Handle initalState onEnter here
+        detail::visit([this](auto&& s) {
+            if constexpr (requires { _context()(s, s, OnEnter{}); }) {
+                _context()(s, s, OnEnter{});
+            } else if constexpr (requires { _context()(s, OnEnter{}); }) {
+                _context()(s, OnEnter{});
+            }
+        }, _state);
+
+        if constexpr (requires { _context.onStart(std::size_t{}); }) {
+            _context.onStart(_state.index());
+        }
+    }
+
+    // Handler result becomes the current state
+    template <class NewStateType>
+    VFSM_ALWAYS_INLINE constexpr void transit(NewStateType &newState)
+    {
+        handleOnExitEnter(newState);
+        // Plain emplace: converting assignment of the variant is a deep call chain in unoptimized builds
+        _state.template emplace<index_of<NewStateType>()>(std::move(newState));
+    }
+
+    // Some OnExit/OnEnter handler of the transition into the State takes both states
+    template <class State>
+    static constexpr bool hasPairedHandlers()
+    {
+        return (handlesPair<State, States>() || ...) || (handlesPair<States, State>() || ...);
+    }
+
+    template <class State>
+    static constexpr bool hasOnExit()
+    {
+        return requires (TableContext &ctx, State &s) { ctx()(s, OnExit{}); };
+    }
+
+    // OnExit of the current state alone: one instantiation for all the targets
+    constexpr void exitState()
+    {
+        if constexpr ((hasOnExit<States>() || ...)) {
+            detail::visit([this](auto&& currentState) {
+                if constexpr (requires { _context()(currentState, OnExit{}); }) {
+                    _context()(currentState, OnExit{});
+                }
+            }, _state);
+        }
     }
 
-private:
     template<typename NewStateType>
-    void handleOnExitEnter(NewStateType& newState)
+    constexpr void handleOnExitEnter(NewStateType& newState)
     {
+        constexpr auto target = index_of<NewStateType>();
+
+#if VFSM_SMALL_FOOTPRINT
+        if constexpr (!hasPairedHandlers<NewStateType>()) {
+            if (_state.index() != target) {
+                exitState();
+                if constexpr (requires { _context.onStateChange(std::size_t{}, std::size_t{}); }) {
+                    _context.onStateChange(_state.index(), target);
+                }
+                if constexpr (requires { _context()(newState, OnEnter{}); }) {
+                    _context()(newState, OnEnter{});
+                }
+            }
+            return;
+        }
+#endif
+
         // onExit/onEnter
-        if (std::holds_alternative<NewStateType>(_state) == false) {
-            std::visit([this,&newState](auto&& currentState) {
+        if (_state.index() != target) {
+            detail::visit([this,&newState](auto&& currentState) {
                 // process current state onExit
                 if constexpr (requires { _context()(currentState, newState, OnExit{}); }) {
                     _context()(currentState, newState, OnExit{});
@@ -193,6 +1208,10 @@ private:
                     _context()(currentState, OnExit{});
                 }
 
+                if constexpr (requires { _context.onStateChange(std::size_t{}, std::size_t{}); }) {
+                    _context.onStateChange(_state.index(), target);
+                }
+
                 // process new state onEnter
                 if constexpr (requires { _context()(newState, currentState, OnEnter{}); }) {
                     _context()(newState, currentState, OnEnter{});
@@ -0,0 +1,311 @@
+//
+// Distributed under MIT license.
+//
+// Copyright 2024 Alexander Drozdov <adrozdoff@gmail.com>
+// Author: Alexander Drozdov <adrozdoff@gmail.com>
+// Site:   https://github.com/h4tr3d/fsm_variant/
+//
+
+#pragma once
+
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <ranges>
+#include <type_traits>
+#include <utility>
+
+#include "vfsm.hpp"
+
+namespace vfsm::views {
+
+/**
+ * Element of the views::run(): machine state after the event and processEvent() result
+ */
+struct Step
+{
+    std::size_t state = 0;
+    bool        handled = false;
+
+    bool operator==(Step const&) const = default;
+};
+
+/**
+ * Lazy single-pass view feeding events of the underlying range into the machine, see views::run()
+ */
+template <std::ranges::input_range Events, class Machine>
+    requires std::ranges::view<Events>
+class RunView : public std::ranges::view_interface<RunView<Events, Machine>>
+{
+    class Sentinel;
+
+    class Iterator
+    {
+    public:
+        using iterator_concept = std::input_iterator_tag;
+        using value_type = Step;
+        using difference_type = std::ranges::range_difference_t<Events>;
+
+        Iterator() = default;
+
+        Iterator(Machine &sm, std::ranges::iterator_t<Events> current)
+            : _sm{std::addressof(sm)},
+              _current{std::move(current)}
+        {}
+
+        Step const& operator*() const
+        {
+            process();
+            return _step;
+        }
+
+        Iterator& operator++()
+        {
+            // Skipped elements are processed too: machine sees every event
+            process();
+            ++_current;
+            _processed = false;
+            return *this;
+        }
+
+        void operator++(int)
+        {
+            ++*this;
+        }
+
+        friend bool operator==(Iterator const& it, Sentinel const& end)
+        {
+            return it._current == end.base();
+        }
+
+    private:
+        // Event is processed once, even if the element is read several times (e.g. by views::filter)
+        void process() const
+        {
+            if (!_processed) {
+                _step.handled = _sm->processEvent(*_current);
+                _step.state = _sm->state_index();
+                _processed = true;
+            }
+        }
+
+        Machine                         *_sm = nullptr;
+        std::ranges::iterator_t<Events>  _current{};
+        mutable Step                     _step{};
+        mutable bool                     _processed = false;
+    };
+
+    class Sentinel
+    {
+    public:
+        Sentinel() = default;
+
+        explicit Sentinel(std::ranges::sentinel_t<Events> end)
+            : _end{std::move(end)}
+        {}
+
+        std::ranges::sentinel_t<Events> const& base() const noexcept
+        {
+            return _end;
+        }
+
+    private:
+        std::ranges::sentinel_t<Events> _end{};
+    };
+
+public:
+    RunView() = default;
+
+    RunView(Events events, Machine &sm)
+        : _events{std::move(events)},
+          _sm{std::addressof(sm)}
+    {}
+
+    Iterator begin()
+    {
+        return {*_sm, std::ranges::begin(_events)};
+    }
+
+    Sentinel end()
+    {
+        return Sentinel{std::ranges::end(_events)};
+    }
+
+private:
+    Events   _events{};
+    Machine *_sm = nullptr;
+};
+
+/**
+ * Stateless forward view of the state indexes of the pure machine, see views::scan_states()
+ */
+template <std::ranges::input_range Events, class Machine>
+    requires std::ranges::view<Events>
+class ScanView : public std::ranges::view_interface<ScanView<Events, Machine>>
+{
+    using Event = std::remove_cvref_t<std::ranges::range_reference_t<Events>>;
+
+    static_assert(Machine::template is_pure<Event>(), "All handlers of the event must be vfsm::pure");
+
+    class Sentinel;
+
+    class Iterator
+    {
+    public:
+        using iterator_concept = std::conditional_t<std::ranges::forward_range<Events>,
+                                                    std::forward_iterator_tag, std::input_iterator_tag>;
+        using iterator_category = iterator_concept;
+        using value_type = std::size_t;
+        using difference_type = std::ranges::range_difference_t<Events>;
+
+        Iterator() = default;
+
+        Iterator(std::size_t state, std::ranges::iterator_t<Events> current)
+            : _state{state},
+              _current{std::move(current)}
+        {}
+
+        // State after the current event
+        std::size_t operator*() const
+        {
+            return Machine::pure_target(_state, *_current);
+        }
+
+        Iterator& operator++()
+        {
+            _state = **this;
+            ++_current;
+            return *this;
+        }
+
+        auto operator++(int)
+        {
+            if constexpr (std::ranges::forward_range<Events>) {
+                auto prev = *this;
+                ++*this;
+                return prev;
+            } else {
+                ++*this;
+            }
+        }
+
+        bool operator==(Iterator const& other) const
+            requires std::ranges::forward_range<Events>
+        {
+            return _current == other._current;
+        }
+
+        friend bool operator==(Iterator const& it, Sentinel const& end)
+        {
+            return it._current == end.base();
+        }
+
+    private:
+        std::size_t                      _state = 0;
+        std::ranges::iterator_t<Events>  _current{};
+    };
+
+    class Sentinel
+    {
+    public:
+        Sentinel() = default;
+
+        explicit Sentinel(std::ranges::sentinel_t<Events> end)
+            : _end{std::move(end)}
+        {}
+
+        std::ranges::sentinel_t<Events> const& base() const noexcept
+        {
+            return _end;
+        }
+
+    private:
+        std::ranges::sentinel_t<Events> _end{};
+    };
+
+public:
+    ScanView() = default;
+
+    ScanView(Events events, std::size_t initial)
+        : _events{std::move(events)},
+          _initial{initial}
+    {}
+
+    Iterator begin()
+    {
+        return {_initial, std::ranges::begin(_events)};
+    }
+
+    Sentinel end()
+    {
+        return Sentinel{std::ranges::end(_events)};
+    }
+
+private:
+    Events      _events{};
+    std::size_t _initial = 0;
+};
+
+namespace detail {
+
+template <class Machine>
+struct RunClosure
+{
+    Machine *sm;
+
+    template <std::ranges::viewable_range Events>
+    friend auto operator|(Events &&events, RunClosure closure)
+    {
+        return RunView<std::views::all_t<Events>, Machine>{std::views::all(std::forward<Events>(events)), *closure.sm};
+    }
+};
+
+template <class Machine>
+struct ScanClosure
+{
+    std::size_t initial;
+
+    template <std::ranges::viewable_range Events>
+    friend auto operator|(Events &&events, ScanClosure closure)
+    {
+        return ScanView<std::views::all_t<Events>, Machine>{std::views::all(std::forward<Events>(events)),
+                                                            closure.initial};
+    }
+};
+
+} // detail
+
+/**
+ * Lazily process every event of the range by the machine, yields views::Step per event.
+ *
+ * Sample:
+ * ```
+ * auto unhandled = std::ranges::count_if(events | vfsm::views::run(sm), [](auto step) { return !step.handled; });
+ * ```
+ */
+template <class Machine>
+detail::RunClosure<Machine> run(Machine &sm)
+{
+    return {std::addressof(sm)};
+}
+
+/**
+ * State index after every event of the range for the pure machine `vfsm::Fsm<TableContext, States...>`, without
+ * machine instance. Handlers of the event must be vfsm::pure over the enumerable event (see vfsm::Domain). OnEnter and
+ * OnExit handlers are not called.
+ *
+ * Sample:
+ * ```
+ * auto frames = std::ranges::count(bytes | std::views::transform([](auto b) { return Ev::Byte{b}; })
+ *                                        | vfsm::views::scan_states<Framer, Idle, Payload, End>(Idle{}),
+ *                                  2);
+ * ```
+ */
+template <class TableContext, class... States, class Initial>
+    requires (std::is_same_v<Initial, States> || ...)
+detail::ScanClosure<Fsm<TableContext, States...>> scan_states(Initial const&)
+{
+    return {Fsm<TableContext, States...>::template index_of<Initial>()};
+}
+
+} // vfsm::views
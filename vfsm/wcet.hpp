@@ -0,0 +1,322 @@
+//
+// Distributed under MIT license.
+//
+// Copyright 2024 Alexander Drozdov <adrozdoff@gmail.com>
+// Author: Alexander Drozdov <adrozdoff@gmail.com>
+// Site:   https://github.com/h4tr3d/fsm_variant/
+//
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <iomanip>
+#include <ostream>
+#include <span>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#  include <x86intrin.h>
+#elif defined(_M_X64) || defined(_M_IX86)
+#  include <intrin.h>
+#endif
+
+#include "vfsm.hpp"
+
+namespace vfsm {
+
+/**
+ * Default counter of the vfsm::Wcet: time stamp counter on x86 (reference cycles, serialized by lfence), virtual
+ * counter on AArch64, steady_clock nanoseconds elsewhere. On microcontrollers supply the own one with the same static
+ * unsigned `now()`, e.g. reading DWT->CYCCNT.
+ */
+struct CycleCounter
+{
+    static std::uint64_t now() noexcept
+    {
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+        _mm_lfence();
+        auto const ticks = __rdtsc();
+        _mm_lfence();
+        return ticks;
+#elif defined(__aarch64__)
+        std::uint64_t ticks;
+        asm volatile("isb; mrs %0, cntvct_el0" : "=r"(ticks) :: "memory");
+        return ticks;
+#else
+        return std::uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+    }
+};
+
+/**
+ * Distribution of the single (state, event) cost, counter ticks with the counter overhead subtracted.
+ *
+ * `max` is the observed worst case and the only value to check deadlines against. `fenced` is informational: the
+ * largest sample within p99 + 3 * (p99 - p50), `outliers` are the samples over it. Many outliers on the unisolated
+ * core point to preemptions and interrupts: rerun pinned rather than discard them.
+ */
+struct WcetStats
+{
+    std::uint64_t min = 0;
+    std::uint64_t p50 = 0;
+    std::uint64_t p99 = 0;
+    std::uint64_t p999 = 0;
+    std::uint64_t fenced = 0;
+    std::uint64_t max = 0;
+    std::size_t   outliers = 0;
+};
+
+/**
+ * Worst-case execution time measurement of the machine: every event sample is processed in every state many times
+ * with the warm caches and after the eviction of the caches, the cost includes the handler and the OnExit/OnEnter
+ * chain of the transition. Machines are created in the state by `make(StateVariant)` outside of the measured
+ * interval, so states must be default constructible.
+ *
+ * Cold run sweeps the data buffer and, with GCC/Clang on x86 and AArch64, 256 KiB of code larger than L1I and the
+ * decoded instruction caches (s_evictsCode). Elsewhere only the data caches are evicted and the report says so.
+ * Branch predictors are not reset.
+ *
+ * Maximum is the observed one: run pinned to the isolated core for a trustworthy bound, see WcetStats.
+ *
+ * Sample:
+ * ```
+ * vfsm::Wcet<Fsm> wcet{1000};
+ * wcet.run([](Fsm::StateVariant &&state) { return Fsm{Controller{}, std::move(state)}; },
+ *          Ev::Tick{0}, Ev::Tick{5000}, Ev::Stop{});
+ * wcet.report(std::cout, Fsm::state_names);
+ * ```
+ */
+template <class Machine, class Counter = CycleCounter>
+class Wcet
+{
+public:
+    using StateVariant = typename Machine::StateVariant;
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__) || defined(__aarch64__))
+    static constexpr bool s_evictsCode = true;
+#else
+    static constexpr bool s_evictsCode = false;
+#endif
+
+    struct Result
+    {
+        std::size_t      state = 0;
+        std::size_t      event = 0; // position of the event sample
+        std::string_view eventName;
+        bool             handled = false;
+        WcetStats        warm;
+        WcetStats        cold;
+    };
+
+    /// Runs per pair, `evictBytes` - buffer swept before every cold run, larger than the last level cache
+    explicit Wcet(std::size_t warmRuns = 1000,
+                  std::size_t coldRuns = 100,
+                  std::size_t evictBytes = std::size_t(32) << 20)
+        : _warmRuns{std::max<std::size_t>(warmRuns, 1)},
+          _coldRuns{std::max<std::size_t>(coldRuns, 1)},
+          _evict(evictBytes)
+    {}
+
+    /**
+     * Measure every (state, event sample) pair, results are appended
+     */
+    template <class Make, class... Events>
+    void run(Make &&make, Events const&... events)
+    {
+        _overhead = overhead();
+        std::size_t event = 0;
+        (measureEvent(make, events, event++), ...);
+    }
+
+    std::span<Result const> results() const noexcept
+    {
+        return _results;
+    }
+
+    /// Counter ticks of the empty measured interval, subtracted from the results
+    std::uint64_t counterOverhead() const noexcept
+    {
+        return _overhead;
+    }
+
+    /// Worst pair by the cold or warm maximum
+    Result const* worst(bool cold = true) const noexcept
+    {
+        auto const it = std::max_element(_results.begin(), _results.end(), [cold](auto const& a, auto const& b) {
+            return (cold ? a.cold.max : a.warm.max) < (cold ? b.cold.max : b.warm.max);
+        });
+        return it == _results.end() ? nullptr : &*it;
+    }
+
+    /**
+     * Table of the pairs in counter ticks, `fenced` and `out` are informational (see WcetStats). Missed state names
+     * are replaced by the indexes.
+     */
+    void report(std::ostream &out, std::span<std::string_view const> stateNames = {}) const
+    {
+        auto name = [&](std::size_t state) -> std::string {
+            return state < stateNames.size() ? std::string{stateNames[state]} : std::to_string(state);
+        };
+        auto stats = [&](WcetStats const& s) {
+            out << std::setw(8) << s.p50 << std::setw(8) << s.p99 << std::setw(8) << s.p999 << std::setw(8) << s.fenced
+                << std::setw(8) << s.max << std::setw(5) << s.outliers;
+        };
+
+        out << _warmRuns << " warm and " << _coldRuns << (s_evictsCode ? " cold" : " D-cache cold")
+            << " runs per pair, counter ticks, overhead " << _overhead << " subtracted\n"
+            << std::left << std::setw(16) << "state" << std::setw(4) << "#" << std::setw(20) << "event"
+            << std::setw(8) << "handled" << std::right
+            << "    warm:  p50     p99   p99.9  fenced     max  out"
+            << (s_evictsCode ? "    cold:" : "  D-cold:") << "  p50     p99   p99.9  fenced     max  out\n";
+        for (auto const& r : _results) {
+            out << std::left << std::setw(16) << name(r.state) << std::setw(4) << r.event << std::setw(20)
+                << r.eventName << std::setw(8) << (r.handled ? "yes" : "no") << std::right << "    ";
+            stats(r.warm);
+            out << "    ";
+            stats(r.cold);
+            out << '\n';
+        }
+    }
+
+private:
+    // Machine is opaque to the optimizer: its state is not known at the measured call
+    static void escape(void const *p) noexcept
+    {
+#if defined(__GNUC__) || defined(__clang__)
+        asm volatile("" : : "r"(p) : "memory");
+#else
+        static void const* volatile s_sink;
+        s_sink = p;
+#endif
+    }
+
+    template <std::size_t I>
+    static StateVariant stateAt()
+    {
+        return StateVariant{std::in_place_index<I>};
+    }
+
+    static StateVariant stateAt(std::size_t index)
+    {
+        return [&]<std::size_t... I>(std::index_sequence<I...>) {
+            constexpr StateVariant (*make[])() = {&stateAt<I>...};
+            return make[index]();
+        }(std::make_index_sequence<Machine::state_count>{});
+    }
+
+    std::uint64_t overhead() const
+    {
+        std::uint64_t best = ~std::uint64_t(0);
+        for (std::size_t i = 0; i < _warmRuns; ++i) {
+            std::atomic_signal_fence(std::memory_order_seq_cst);
+            auto const start = Counter::now();
+            std::atomic_signal_fence(std::memory_order_seq_cst);
+            auto const stop = Counter::now();
+            best = std::min<std::uint64_t>(best, stop - start);
+        }
+        return best;
+    }
+
+    // Straight-line code over the instruction caches: 32Ki 8-byte NOPs on x86, 64Ki 4-byte ones on AArch64
+    [[gnu::noinline]] static void sweepCode() noexcept
+    {
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+        asm volatile(".rept 32768\n\t.byte 0x0f, 0x1f, 0x84, 0x00, 0x00, 0x00, 0x00, 0x00\n\t.endr" ::: "memory");
+#elif (defined(__GNUC__) || defined(__clang__)) && defined(__aarch64__)
+        asm volatile(".rept 65536\n\tnop\n\t.endr" ::: "memory");
+#endif
+    }
+
+    void evict()
+    {
+        // Read and write every line: dirty lines of the machine are written back as well
+        for (std::size_t i = 0; i < _evict.size(); i += 64)
+            _evict[i] = static_cast<unsigned char>(_evict[i] + 1);
+        escape(_evict.data());
+        if constexpr (s_evictsCode)
+            sweepCode();
+    }
+
+    template <class Make, class Event>
+    void measureEvent(Make &make, Event const& event, std::size_t column)
+    {
+        for (std::size_t state = 0; state < Machine::state_count; ++state) {
+            Result result{state, column, type_name<Event>(), false, {}, {}};
+            std::vector<std::uint64_t> warm;
+            std::vector<std::uint64_t> cold;
+            warm.reserve(_warmRuns);
+            cold.reserve(_coldRuns);
+
+            // First warm run only warms up
+            for (std::size_t i = 0; i <= _warmRuns; ++i) {
+                auto const ticks = measure(make, state, event, false, result.handled);
+                if (i > 0)
+                    warm.push_back(ticks);
+            }
+            for (std::size_t i = 0; i < _coldRuns; ++i)
+                cold.push_back(measure(make, state, event, true, result.handled));
+
+            result.warm = summarize(warm);
+            result.cold = summarize(cold);
+            _results.push_back(result);
+        }
+    }
+
+    template <class Make, class Event>
+    std::uint64_t measure(Make &make, std::size_t state, Event const& event, bool cold, bool &handled)
+    {
+        Machine sm = make(stateAt(state));
+        Event ev = event;
+        if (cold)
+            evict();
+        escape(&sm);
+        escape(&ev);
+
+        std::atomic_signal_fence(std::memory_order_seq_cst);
+        auto const start = Counter::now();
+        std::atomic_signal_fence(std::memory_order_seq_cst);
+        handled = sm.processEvent(ev);
+        std::atomic_signal_fence(std::memory_order_seq_cst);
+        auto const stop = Counter::now();
+        std::atomic_signal_fence(std::memory_order_seq_cst);
+
+        escape(&sm);
+        std::uint64_t const ticks = stop - start;
+        return ticks > _overhead ? ticks - _overhead : 0;
+    }
+
+    static WcetStats summarize(std::vector<std::uint64_t> &ticks)
+    {
+        std::sort(ticks.begin(), ticks.end());
+        auto at = [&](double q) {
+            auto const rank = std::size_t(q * double(ticks.size()));
+            return ticks[std::min(rank, ticks.size() - 1)];
+        };
+        // Fence of the far outliers by the spread of the tail itself: the cold distribution is often bimodal
+        auto const p50 = at(0.5);
+        auto const p99 = at(0.99);
+        auto const fence = p99 + 3 * (p99 - p50);
+        auto const inside = std::upper_bound(ticks.begin(), ticks.end(), fence);
+        auto const outliers = std::size_t(ticks.end() - inside);
+        return {ticks.front(), p50, p99, at(0.999), *(inside - 1), ticks.back(), outliers};
+    }
+
+private:
+    std::size_t                _warmRuns;
+    std::size_t                _coldRuns;
+    std::vector<unsigned char> _evict;
+    std::uint64_t              _overhead = 0;
+    std::vector<Result>        _results;
+};
+
+} // vfsm